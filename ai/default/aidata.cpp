@@ -54,6 +54,7 @@ void dai_data_init(struct ai_type *ait, struct player *pplayer)
   struct ai_plr *ai = def_ai_player_data(pplayer, ait);
 
   ai->phase_initialized = false;
+  ai->phase_planned = false;
 
   ai->last_num_continents = -1;
   ai->last_num_oceans = -1;
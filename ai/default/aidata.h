@@ -10,6 +10,9 @@
 #pragma once
 
 #include <QHash>
+#include <QList>
+#include <QPair>
+#include <vector>
 // utility
 #include "support.h"
 
@@ -60,8 +63,22 @@ struct ai_dip_intel {
   signed char warned_about_space;
 };
 
+/* What the danger assessment of a city found while the game state was
+ * frozen, applied later by dai_apply_danger_plans(). */
+struct dai_danger_plan {
+  int city_id;
+  int urgency;
+  // Building index -> danger the building would help against.
+  std::vector<int> danger_reduced;
+  // Attacker type -> want for a defender against it.
+  QList<QPair<const struct unit_type *, int>> defender_wants;
+};
+
 struct ai_plr {
   bool phase_initialized;
+  // Danger was assessed by dai_plan_first_activities() for this phase.
+  bool phase_planned;
+  QList<struct dai_danger_plan> danger_plans;
 
   int last_num_continents;
   int last_num_oceans;
@@ -724,14 +724,34 @@ static void dai_manage_government(struct ai_type *ait,
   }
 }
 
+/**
+   Read-only part of dai_do_first_activities(), run in a worker thread when
+   the server plans AI players in parallel. It must not change anything but
+   the danger data of the cities of pplayer; the rest is recorded for
+   dai_do_first_activities().
+ */
+void dai_plan_first_activities(struct ai_type *ait, struct player *pplayer)
+{
+  dai_plan_danger_player(ait, pplayer, &(wld.map));
+  def_ai_player_data(pplayer, ait)->phase_planned = true;
+}
+
 /**
    Activities to be done by AI _before_ human turn.  Here we just move the
    units intelligently.
  */
 void dai_do_first_activities(struct ai_type *ait, struct player *pplayer)
 {
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+
   TIMING_LOG(AIT_ALL, TIMER_START);
-  dai_assess_danger_player(ait, pplayer, &(wld.map));
+  if (plr_data->phase_planned) {
+    // Assessed by dai_plan_first_activities(), apply the resulting wants.
+    dai_apply_danger_plans(ait, pplayer);
+    plr_data->phase_planned = false;
+  } else {
+    dai_assess_danger_player(ait, pplayer, &(wld.map));
+  }
   /* TODO: Make assess_danger save information on what is threatening
    * us and make dai_manage_units and Co act upon this information, trying
    * to eliminate the source of danger */
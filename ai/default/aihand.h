@@ -12,6 +12,7 @@
 
 #include "fc_types.h"
 
+void dai_plan_first_activities(struct ai_type *ait, struct player *pplayer);
 void dai_do_first_activities(struct ai_type *ait, struct player *pplayer);
 void dai_do_last_activities(struct ai_type *ait, struct player *pplayer);
 
@@ -413,7 +413,7 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
     return true;
   }
 
-  pfm = pf_map_new(parameter);
+  pfm = pf_map_new_goal(parameter, ptile);
   auto path = pf_map_path(pfm, ptile);
 
   if (!path.empty()) {
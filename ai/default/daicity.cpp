@@ -12,6 +12,10 @@
       \____/        ********************************************************/
 
 #include <cstring>
+#include <vector>
+
+// Qt
+#include <QThreadPool>
 
 // utility
 #include "rand.h"
@@ -20,6 +24,7 @@
 
 // common
 #include "actions.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "research.h"
@@ -1489,17 +1494,23 @@ adv_want dai_city_want(struct player *pplayer, struct city *acity,
   return want;
 }
 
+// A base_want() evaluation of dai_build_adv_adjust().
+struct base_want_job {
+  struct city *pcity;
+  struct impr_type *pimprove;
+  adv_want want;
+};
+
 /**
-   Calculates want for some buildings by actually adding the building and
-   measuring the effect.
+   Calculates want for some buildings by pretending the building is there
+   and measuring the effect. Only the city overlay of the calling thread is
+   changed, so this can run in parallel for several cities.
  */
 static adv_want base_want(struct ai_type *ait, struct player *pplayer,
-                          struct city *pcity, struct impr_type *pimprove)
+                          struct adv_data *adv, struct city *pcity,
+                          struct impr_type *pimprove)
 {
-  struct adv_data *adv = adv_data_get(pplayer, nullptr);
   adv_want final_want = 0;
-  int wonder_player_id = WONDER_NOT_OWNED;
-  int wonder_city_id = WONDER_NOT_BUILT;
 
   if (adv->impr_calc[improvement_index(pimprove)] == ADV_IMPR_ESTIMATE) {
     return 0; // Nothing to calculate here.
@@ -1511,15 +1522,8 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
     return 0;
   }
 
-  if (is_wonder(pimprove)) {
-    if (is_great_wonder(pimprove)) {
-      wonder_player_id =
-          game.info.great_wonder_owners[improvement_index(pimprove)];
-    }
-    wonder_city_id = pplayer->wonders[improvement_index(pimprove)];
-  }
   // Add the improvement
-  city_add_improvement(pcity, pimprove);
+  city_overlay_set(pcity, pimprove);
 
   // Stir, then compare notes
   city_range_iterate(pcity, pplayer->cities,
@@ -1531,15 +1535,7 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
   city_range_iterate_end;
 
   // Restore
-  city_remove_improvement(pcity, pimprove);
-  if (is_wonder(pimprove)) {
-    if (is_great_wonder(pimprove)) {
-      game.info.great_wonder_owners[improvement_index(pimprove)] =
-          wonder_player_id;
-    }
-
-    pplayer->wonders[improvement_index(pimprove)] = wonder_city_id;
-  }
+  city_overlay_clear();
 
   return final_want;
 }
@@ -1572,12 +1568,15 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
 
    IDEA: Calculate per-continent aggregates of various data, and use this
    for wonders below for better wonder placements.
+
+   'base' is the result of base_want() for the city and improvement.
  */
 static void adjust_improvement_wants_by_effects(struct ai_type *ait,
                                                 struct player *pplayer,
                                                 struct city *pcity,
                                                 struct impr_type *pimprove,
-                                                const bool already)
+                                                const bool already,
+                                                adv_want base)
 {
   adv_want v = 0;
   int cities[REQ_RANGE_COUNT];
@@ -1612,7 +1611,7 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
     v += float(TRADE_WEIGHTING) / 10;
   } else {
     // Base want is calculated above using a more direct approach.
-    v += base_want(ait, pplayer, pcity, pimprove);
+    v += base;
     if (v != 0) {
       CITY_LOG(LOG_DEBUG, pcity,
                "%s base_want is " ADV_WANT_PRINTF " (range=%d)",
@@ -1938,6 +1937,35 @@ void dai_build_adv_init(struct ai_type *ait, struct player *pplayer)
   city_list_iterate_end;
 }
 
+/**
+   Fills in the base_want() of all jobs. The jobs are independent, so they
+   are spread over a thread pool when the server plans AI players in
+   parallel.
+ */
+static void base_wants_compute(struct ai_type *ait, struct player *pplayer,
+                               std::vector<base_want_job> &jobs)
+{
+  struct adv_data *adv = adv_data_get(pplayer, nullptr);
+
+  if (!game.server.parallel_ai || jobs.size() < 2) {
+    for (auto &job : jobs) {
+      job.want = base_want(ait, pplayer, adv, job.pcity, job.pimprove);
+    }
+    return;
+  }
+
+  QThreadPool pool;
+
+  effect_cache_freeze(true);
+  for (auto &job : jobs) {
+    pool.start([ait, pplayer, adv, &job] {
+      job.want = base_want(ait, pplayer, adv, job.pcity, job.pimprove);
+    });
+  }
+  pool.waitForDone();
+  effect_cache_freeze(false);
+}
+
 /**
    Calculate how much an AI player should want to build particular
    improvements, because of the effects of those improvements, and
@@ -1947,6 +1975,7 @@ void dai_build_adv_init(struct ai_type *ait, struct player *pplayer)
 void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
                           struct city *wonder_city)
 {
+  std::vector<base_want_job> jobs;
   /* Clear old building wants.
    * Do this separately from the iteration over improvement types
    * because each iteration could actually update more than one improvement,
@@ -1977,6 +2006,27 @@ void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
   }
   city_list_iterate_end;
 
+  /* Evaluate the base wants up front, in the same order as they are used
+   * below. */
+  improvement_iterate(pimprove)
+  {
+    if (!improvement_has_flag(pimprove, IF_GOLD)
+        && can_player_build_improvement_later(pplayer, pimprove)) {
+      city_list_iterate(pplayer->cities, pcity)
+      {
+        if ((pcity == wonder_city || !is_wonder(pimprove))
+            && def_ai_city_data(pcity, ait)->building_turn
+                   <= game.info.turn) {
+          jobs.push_back({pcity, pimprove, 0});
+        }
+      }
+      city_list_iterate_end;
+    }
+  }
+  improvement_iterate_end;
+  base_wants_compute(ait, pplayer, jobs);
+  auto job = jobs.cbegin();
+
   improvement_iterate(pimprove)
   {
     const bool is_coinage = improvement_has_flag(pimprove, IF_GOLD);
@@ -1998,9 +2048,15 @@ void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
            * we already have. */
           const bool already = city_has_building(pcity, pimprove);
           int idx = improvement_index(pimprove);
+          adv_want base = 0;
 
+          if (!is_coinage) {
+            fc_assert_ret(job != jobs.cend());
+            fc_assert(job->pcity == pcity && job->pimprove == pimprove);
+            base = (job++)->want;
+          }
           adjust_improvement_wants_by_effects(ait, pplayer, pcity, pimprove,
-                                              already);
+                                              already, base);
 
           fc_assert(!(already && 0 < pcity->server.adv->building_want[idx]));
 
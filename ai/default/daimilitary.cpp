@@ -12,6 +12,7 @@
       \____/        ********************************************************/
 
 #include <cstring>
+#include <utility> // std::as_const
 
 // utility
 #include "log.h"
@@ -62,9 +63,17 @@
 #include "daieffects.h"
 #include "daimilitary.h"
 
+static struct pf_reverse_map *
+assess_danger_map_new(const struct player *pplayer,
+                      const struct player *aplayer, struct tile *ptile,
+                      const struct civ_map *dmap);
 static int assess_danger(struct ai_type *ait, struct city *pcity,
                          const struct civ_map *dmap,
-                         player_unit_list_getter ul_cb);
+                         player_unit_list_getter ul_cb,
+                         struct pf_reverse_map **player_maps,
+                         struct dai_danger_plan *plan);
+static void assess_danger_buildings(struct ai_type *ait, struct city *pcity,
+                                    int urgency, const int *danger_reduced);
 
 /**
    Choose the best unit the city can build to defend against attacker v.
@@ -374,13 +383,13 @@ static int assess_danger_unit(const struct city *pcity,
                   / punittype->paratroopers_range);
   }
 
-  if (pf_reverse_map_unit_position(pcity_map, punit, &pos)
+  if (pf_reverse_map_unit_position_to(pcity_map, punit, ptile, &pos)
       && (PF_IMPOSSIBLE_MC == *move_time || *move_time > pos.turn)) {
     *move_time = pos.turn;
   }
 
   if (unit_transported(punit) && (ferry = unit_transport_get(punit))
-      && pf_reverse_map_unit_position(pcity_map, ferry, &pos)) {
+      && pf_reverse_map_unit_position_to(pcity_map, ferry, ptile, &pos)) {
     if ((PF_IMPOSSIBLE_MC == *move_time || *move_time > pos.turn)) {
       *move_time = pos.turn;
       if (!can_attack_from_non_native(punittype)) {
@@ -408,21 +417,126 @@ static int assess_danger_unit(const struct city *pcity,
 }
 
 /**
-   Call assess_danger() for all cities owned by pplayer.
+   Create the reverse map used to find when the units of 'aplayer' can
+   reach 'ptile', a tile of 'pplayer'. More tiles may be added with
+   pf_reverse_map_add_target().
+ */
+static struct pf_reverse_map *
+assess_danger_map_new(const struct player *pplayer,
+                      const struct player *aplayer, struct tile *ptile,
+                      const struct civ_map *dmap)
+{
+  int assess_turns = (player_is_cpuhog(pplayer) ? 6 : 3);
 
-   This is necessary to initialize some ai data before some ai calculations.
+  return pf_reverse_map_new(aplayer, ptile, assess_turns,
+                            !has_handicap(pplayer, H_MAP), dmap);
+}
+
+/**
+   Call assess_danger() for all cities owned by pplayer. With plans, the
+   parts that change more than the danger data of the cities are left to
+   dai_apply_danger_plans().
  */
-void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
-                              const struct civ_map *dmap)
+static void assess_danger_player(struct ai_type *ait,
+                                 struct player *pplayer,
+                                 const struct civ_map *dmap,
+                                 QList<struct dai_danger_plan> *plans)
 {
+  struct pf_reverse_map *player_maps[MAX_NUM_PLAYER_SLOTS] = {nullptr};
+
   // Do nothing if game is not running
-  if (S_S_RUNNING == server_state()) {
+  if (S_S_RUNNING != server_state()
+      || 0 == city_list_size(pplayer->cities)) {
+    return;
+  }
+
+  /* One reverse map per dangerous player, targeting all our cities: each
+   * enemy unit is then iterated once instead of once per city. */
+  players_iterate(aplayer)
+  {
+    if (!adv_is_player_dangerous(pplayer, aplayer)) {
+      continue;
+    }
+
+    auto *pfrm = assess_danger_map_new(
+        pplayer, aplayer, city_tile(city_list_get(pplayer->cities, 0)),
+        dmap);
     city_list_iterate(pplayer->cities, pcity)
     {
-      (void) assess_danger(ait, pcity, dmap, nullptr);
+      pf_reverse_map_add_target(pfrm, city_tile(pcity));
     }
     city_list_iterate_end;
+    player_maps[player_index(aplayer)] = pfrm;
+  }
+  players_iterate_end;
+
+  city_list_iterate(pplayer->cities, pcity)
+  {
+    if (nullptr != plans) {
+      plans->append(dai_danger_plan());
+      (void) assess_danger(ait, pcity, dmap, nullptr, player_maps,
+                           &plans->last());
+    } else {
+      (void) assess_danger(ait, pcity, dmap, nullptr, player_maps, nullptr);
+    }
+  }
+  city_list_iterate_end;
+
+  for (auto *pfrm : player_maps) {
+    if (nullptr != pfrm) {
+      pf_reverse_map_destroy(pfrm);
+    }
+  }
+}
+
+/**
+   Call assess_danger() for all cities owned by pplayer.
+
+   This is necessary to initialize some ai data before some ai calculations.
+ */
+void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
+                              const struct civ_map *dmap)
+{
+  assess_danger_player(ait, pplayer, dmap, nullptr);
+}
+
+/**
+   Same as dai_assess_danger_player(), but safe to run in a worker thread
+   while the game state is frozen: only the danger data of the cities of
+   pplayer is written. Tech and building wants are recorded instead, and
+   dai_apply_danger_plans() must be called afterwards.
+ */
+void dai_plan_danger_player(struct ai_type *ait, struct player *pplayer,
+                            const struct civ_map *dmap)
+{
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+
+  plr_data->danger_plans.clear();
+  assess_danger_player(ait, pplayer, dmap, &plr_data->danger_plans);
+}
+
+/**
+   Apply the tech and building wants recorded by dai_plan_danger_player().
+   Cities lost in the meantime are skipped.
+ */
+void dai_apply_danger_plans(struct ai_type *ait, struct player *pplayer)
+{
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+
+  for (const auto &plan : std::as_const(plr_data->danger_plans)) {
+    struct city *pcity = game_city_by_number(plan.city_id);
+
+    if (nullptr == pcity || city_owner(pcity) != pplayer) {
+      continue;
+    }
+
+    for (const auto &[utype, want] : plan.defender_wants) {
+      (void) dai_wants_defender_against(ait, pplayer, pcity, utype, want);
+    }
+    assess_danger_buildings(ait, pcity, plan.urgency,
+                            plan.danger_reduced.data());
   }
+  plr_data->danger_plans.clear();
 }
 
 /**
@@ -477,25 +591,26 @@ static void dai_reevaluate_building(struct city *pcity, adv_want *value,
    FIXME: Due to the nature of assess_distance, a city will only be
    afraid of a boat laden with enemies if it stands on the coast (i.e.
    is directly reachable by this boat).
+
+   With a plan, nothing but the danger data of pcity is written; the tech
+   and building wants are recorded in the plan instead.
  */
 static int assess_danger(struct ai_type *ait, struct city *pcity,
                          const struct civ_map *dmap,
-                         player_unit_list_getter ul_cb)
+                         player_unit_list_getter ul_cb,
+                         struct pf_reverse_map **player_maps,
+                         struct dai_danger_plan *plan)
 {
   struct player *pplayer = city_owner(pcity);
   struct tile *ptile = city_tile(pcity);
   struct ai_city *city_data = def_ai_city_data(pcity, ait);
   int danger_reduced[B_LAST]; /* How much such danger there is that
                                * building would help against. */
-  int i;
   int defender;
   int urgency = 0;
-  int defense;
   int total_danger = 0;
   int defense_bonuses_pct[U_LAST];
   bool defender_type_handled[U_LAST] = {false};
-  int assess_turns;
-  bool omnimap;
 
   TIMING_LOG(AIT_DANGER, TIMER_START);
 
@@ -550,14 +665,6 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
   }
   unit_list_iterate_end;
 
-  if (player_is_cpuhog(pplayer)) {
-    assess_turns = 6;
-  } else {
-    assess_turns = 3;
-  }
-
-  omnimap = !has_handicap(pplayer, H_MAP);
-
   // Check.
   players_iterate(aplayer)
   {
@@ -570,8 +677,12 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
     /* Note that we still consider the units of players we are not (yet)
      * at war with. */
 
-    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
-                                            omnimap, dmap);
+    if (nullptr != player_maps) {
+      pcity_map = player_maps[player_index(aplayer)];
+      fc_assert_action(nullptr != pcity_map, continue);
+    } else {
+      pcity_map = assess_danger_map_new(pplayer, aplayer, ptile, dmap);
+    }
 
     if (ul_cb != nullptr) {
       units = ul_cb(aplayer);
@@ -614,8 +725,13 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
         defbonus_pct = (defbonus_pct + 100) / 2;
       }
       vulnerability = vulnerability * 100 / (defbonus_pct + 100);
-      (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
-                                        vulnerability / MAX(move_time, 1));
+      if (nullptr != plan) {
+        plan->defender_wants.append(
+            {utype, vulnerability / MAX(move_time, 1)});
+      } else {
+        (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
+                                          vulnerability / MAX(move_time, 1));
+      }
 
       if (utype_acts_hostile(unit_type_get(punit)) && 2 >= move_time) {
         city_data->diplomat_threat = true;
@@ -646,7 +762,9 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
     }
     unit_list_iterate_end;
 
-    pf_reverse_map_destroy(pcity_map);
+    if (nullptr == player_maps) {
+      pf_reverse_map_destroy(pcity_map);
+    }
   }
   players_iterate_end;
 
@@ -663,17 +781,13 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
     urgency += 10 * city_data->grave_danger;
   }
 
-  /* HACK: This needs changing if multiple improvements provide
-   * this effect. */
-  /* FIXME: Accept only buildings helping unit classes we actually use.
-   *        Now we consider any land mover helper suitable. */
-  defense = assess_defense_igwall(ait, pcity);
-
-  for (i = 0; i < B_LAST; i++) {
-    if (0 < danger_reduced[i]) {
-      dai_reevaluate_building(pcity, &pcity->server.adv->building_want[i],
-                              urgency, danger_reduced[i], defense);
-    }
+  if (nullptr != plan) {
+    // assess_defense_igwall() changes the activity of the defenders.
+    plan->city_id = pcity->id;
+    plan->urgency = urgency;
+    plan->danger_reduced.assign(danger_reduced, danger_reduced + B_LAST);
+  } else {
+    assess_danger_buildings(ait, pcity, urgency, danger_reduced);
   }
 
   if (has_handicap(pplayer, H_DANGER) && 0 == total_danger) {
@@ -690,6 +804,27 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
   return urgency;
 }
 
+/**
+   Raise the want for the buildings that would help pcity against the
+   danger found by assess_danger().
+ */
+static void assess_danger_buildings(struct ai_type *ait, struct city *pcity,
+                                    int urgency, const int *danger_reduced)
+{
+  /* HACK: This needs changing if multiple improvements provide
+   * this effect. */
+  /* FIXME: Accept only buildings helping unit classes we actually use.
+   *        Now we consider any land mover helper suitable. */
+  int defense = assess_defense_igwall(ait, pcity);
+
+  for (int i = 0; i < B_LAST; i++) {
+    if (0 < danger_reduced[i]) {
+      dai_reevaluate_building(pcity, &pcity->server.adv->building_want[i],
+                              urgency, danger_reduced[i], defense);
+    }
+  }
+}
+
 /**
    How much we would want that unit to defend a city? (Do not use this
    function to find bodyguards for ships or air units.)
@@ -1466,7 +1601,7 @@ struct adv_choice *military_advisor_choose_build(
   struct adv_choice *choice = adv_new_choice();
   bool allow_gold_upkeep;
 
-  urgency = assess_danger(ait, pcity, mamap, ul_cb);
+  urgency = assess_danger(ait, pcity, mamap, ul_cb, nullptr, nullptr);
   /* Changing to quadratic to stop AI from building piles
    * of small units -- Syela */
   // It has to be AFTER assess_danger thanks to wallvalue.
@@ -520,7 +520,7 @@ int client_main(int argc, char *argv[])
 
   // initialization
   game.all_connections = conn_list_new();
-  game.est_connections = conn_list_new();
+  game.est_connections = conn_list_new_pooled();
 
   charsets_init();
   update_queue::uq()->init();
@@ -801,6 +801,9 @@ void set_client_state(enum client_states newstate)
     popdown_all_game_dialogs();
     meswin_clear_older(MESWIN_CLEAR_ALL, 0);
 
+    client.session.token[0] = '\0';
+    client.session.resuming = false;
+
     if (oldstate > C_S_DISCONNECTED) {
       unit_focus_set(nullptr);
       editor_clear();
@@ -87,6 +87,14 @@ extern struct civclient {
   // this is the client's connection to the server
   client_connection conn;
   struct global_worklist_list *worklists;
+
+  // The session given by the server, to resume it after losing the
+  // connection (see reconnect_to_server()).
+  struct {
+    char token[MAX_LEN_SESSION_TOKEN]; // Empty if the server gave none
+    int stamp;                         // We have all changes until this
+    bool resuming; // Set until we got the changes, or were told we won't
+  } session;
 } client;
 
 bool client_is_observer();
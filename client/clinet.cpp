@@ -207,6 +207,15 @@ void make_connection(QIODevice *sock, const QString &username)
   // call gui-dependent stuff in gui_main.c
   add_net_input(client.conn.sock);
 
+  // Ask to resume our session first, see reconnect_to_server().
+  if (client.session.resuming) {
+    struct packet_session_resume_req resume;
+
+    sz_strlcpy(resume.token, client.session.token);
+    resume.stamp = client.session.stamp;
+    send_packet_session_resume_req(&client.conn, &resume);
+  }
+
   // now send join_request package
 
   req.major_version = MAJOR_VERSION;
@@ -247,6 +256,31 @@ void disconnect_from_server()
   }
 }
 
+/**
+   Connects again to the server after the connection was lost. If the
+   server gave us a session, we keep the game and ask the server to only
+   send what changed in the meantime. Returns like connect_to_server().
+ */
+int reconnect_to_server(char *errbuf, int errbufsize)
+{
+  if ('\0' == client.session.token[0]
+      || (C_S_RUNNING != client_state() && C_S_OVER != client_state())) {
+    disconnect_from_server();
+    return connect_to_server(client_url(), errbuf, errbufsize);
+  }
+
+  // The server sends them again.
+  client_remove_all_cli_conn();
+
+  client.session.resuming = true;
+  if (connect_to_server(client_url(), errbuf, errbufsize) < 0) {
+    client.session.resuming = false;
+    return -1;
+  }
+
+  return 0;
+}
+
 /**
    A wrapper around read_socket_data() which also handles the case the
    socket becomes writeable and there is still data which should be sent
@@ -21,6 +21,7 @@ void make_connection(QIODevice *sock, const QString &username);
 
 void input_from_server(QIODevice *sock);
 void disconnect_from_server();
+int reconnect_to_server(char *errbuf, int errbufsize);
 
 double try_to_autoconnect(const QUrl &url);
 void start_autoconnecting_to_server(const QUrl &url);
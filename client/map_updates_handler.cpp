@@ -6,11 +6,24 @@
 
 #include "map_updates_handler.h"
 #include "city.h"
+#include "map.h"
 #include "options.h"
 #include "tileset/tilespec.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace freeciv {
 
+namespace /* anonymous */ {
+/// The last version handed out
+unsigned long last_version = 1;
+/// The version of all tiles after the last update_all()
+unsigned long all_version = 1;
+/// The version of tiles updated since, by tile index
+std::vector<unsigned long> tile_versions;
+} // anonymous namespace
+
 /**
  * @class map_updates_handler
  * @brief Records regions of the map that should be updated
@@ -44,6 +57,7 @@ void map_updates_handler::clear()
  */
 void map_updates_handler::update(const city *city, bool full)
 {
+  invalidate(city_tile(city));
   if (!m_full_update) {
     const auto tile = city_tile(city);
     if (full && (gui_options->draw_map_grid || gui_options->draw_borders)) {
@@ -61,6 +75,7 @@ void map_updates_handler::update(const city *city, bool full)
  */
 void map_updates_handler::update(const tile *tile, bool full)
 {
+  invalidate(tile);
   if (!m_full_update) {
     if (full) {
       m_updates[tile] |= update_type::tile_full;
@@ -76,6 +91,7 @@ void map_updates_handler::update(const tile *tile, bool full)
  */
 void map_updates_handler::update(const unit *unit, bool full)
 {
+  invalidate(unit_tile(unit));
   if (!m_full_update) {
     const auto tile = unit_tile(unit);
     if (full && gui_options->draw_native) {
@@ -95,6 +111,7 @@ void map_updates_handler::update(const unit *unit, bool full)
  */
 void map_updates_handler::update_all()
 {
+  invalidate_all();
   m_updates.clear();
   m_full_update = true;
   emit repaint_needed();
@@ -123,4 +140,52 @@ void map_updates_handler::update_tile_label(const tile *tile)
   }
 }
 
+/**
+ * Returns a number that changes every time the tile is registered for an
+ * update, directly or through one of its neighbors (whose look depends on
+ * it), and when the whole map is. Used to cache what is drawn on tiles.
+ */
+unsigned long map_updates_handler::tile_version(const tile *tile)
+{
+  const auto index = static_cast<std::size_t>(tile_index(tile));
+  if (index >= tile_versions.size()) {
+    return all_version;
+  }
+  return std::max(tile_versions[index], all_version);
+}
+
+/**
+ * Changes the version of a tile and its neighbors.
+ * @see tile_version
+ */
+void map_updates_handler::invalidate(const tile *tile)
+{
+  if (tile == nullptr || map_is_empty()) {
+    return;
+  }
+
+  if (tile_versions.size() != static_cast<std::size_t>(MAP_INDEX_SIZE)) {
+    // The map was (re)allocated
+    tile_versions.assign(MAP_INDEX_SIZE, 0);
+    all_version = ++last_version;
+  }
+
+  const auto version = ++last_version;
+  tile_versions[tile_index(tile)] = version;
+  adjc_iterate(&(wld.map), tile, adjc_tile)
+  {
+    tile_versions[tile_index(adjc_tile)] = version;
+  }
+  adjc_iterate_end;
+}
+
+/**
+ * Changes the version of all tiles.
+ * @see tile_version
+ */
+void map_updates_handler::invalidate_all()
+{
+  all_version = ++last_version;
+}
+
 } // namespace freeciv
@@ -54,10 +54,15 @@ class map_updates_handler : public QObject,
   void update_city_description(const city *city);
   void update_tile_label(const tile *tile);
 
+  static unsigned long tile_version(const tile *tile);
+  static void invalidate_all();
+
 signals:
   void repaint_needed();
 
 private:
+  static void invalidate(const tile *tile);
+
   bool m_full_update = false;
   std::map<const tile *, updates> m_updates;
 };
@@ -24,10 +24,16 @@ received a copy of the GNU General Public License along with Freeciv21.
 #include "overview_common.h"
 
 // Qt
+#include <QImage>
 #include <QPainter>
 #include <QPixmap>
+#include <QThread>
+#include <QThreadPool>
 #include <qnamespace.h>
 
+// std
+#include <algorithm>
+
 int OVERVIEW_TILE_SIZE = 2;
 
 #if 0
@@ -49,12 +55,33 @@ namespace /* anonymous */ {
  */
 static bool overview_dirty = false;
 
+/*
+ * The backing store. Tiles are drawn into it pixel by pixel, and the part
+ * that changed (overview_image_dirty) is copied to overview.map once per
+ * redraw.
+ */
+static QImage overview_image;
+static QRect overview_image_dirty;
+
 // Tracks map updates for the overview
 static std::unique_ptr<freeciv::map_updates_handler> updates = nullptr;
 
+/*
+ * Raw access to the pixels of overview_image. Taken once before drawing so
+ * that several threads can write to disjoint rows without detaching the
+ * image.
+ */
+struct overview_pixels {
+  uchar *bits;
+  qsizetype bytes_per_line;
+  QRect rect;
+};
+
 } // anonymous namespace
 
 static void overview_update_tile(const tile *ptile);
+static QRect overview_draw_tile(const overview_pixels &pixels,
+                                const tile *ptile);
 
 /**
    Translate from gui to natural coordinate systems.  This provides natural
@@ -197,6 +224,14 @@ static void redraw_overview()
     return;
   }
 
+  if (!overview_image_dirty.isEmpty()) {
+    QPainter p(gui_options->overview.map);
+    p.drawImage(overview_image_dirty.topLeft(), overview_image,
+                overview_image_dirty);
+    p.end();
+    overview_image_dirty = QRect();
+  }
+
   {
     QPixmap *src = gui_options->overview.map;
     QPixmap *dst = gui_options->overview.window;
@@ -275,47 +310,89 @@ void overview_to_map_pos(int *map_x, int *map_y, int overview_x,
   fc_assert(normalize_map_pos(&(wld.map), map_x, map_y));
 }
 
+/**
+   Returns raw access to the pixels of the backing store.
+ */
+static overview_pixels overview_pixels_get()
+{
+  return {overview_image.bits(), overview_image.bytesPerLine(),
+          overview_image.rect()};
+}
+
 /**
    Redraw the entire backing store for the overview minimap.
+
+   The map is cut into stripes of native rows. Each stripe covers its own
+   rows of the overview, so the stripes are drawn in parallel. The game
+   state is only read while the main thread waits.
  */
 void refresh_overview_canvas()
 {
-  if (!can_client_change_view()) {
+  if (!can_client_change_view() || overview_image.isNull()) {
     return;
   }
-  whole_map_iterate(&(wld.map), ptile) { overview_update_tile(ptile); }
-  whole_map_iterate_end;
+
+  const auto pixels = overview_pixels_get();
+  const int stripes =
+      std::clamp(QThread::idealThreadCount(), 1, wld.map.ysize);
+  QThreadPool pool;
+
+  for (int s = 0; s < stripes; s++) {
+    const int first = wld.map.ysize * s / stripes * wld.map.xsize;
+    const int last = wld.map.ysize * (s + 1) / stripes * wld.map.xsize;
+
+    pool.start([&pixels, first, last] {
+      for (int i = first; i < last; i++) {
+        overview_draw_tile(pixels, wld.map.tiles + i);
+      }
+    });
+  }
+  pool.waitForDone();
+
+  overview_image_dirty = overview_image.rect();
   redraw_overview();
 }
 
 /**
-   Draws the color for this tile onto the given rectangle of the canvas.
+   Fills the given rectangle of the backing store with a color, clipped to
+   the image. Returns the rectangle actually filled.
 
-   This is just a simple helper function for overview_update_tile, since
+   This is just a simple helper function for overview_draw_tile, since
    sometimes a tile may cover more than one rectangle.
  */
-static void put_overview_tile_area(QPixmap *pcanvas, const tile *ptile,
-                                   int x, int y, int w, int h)
+static QRect put_overview_tile_area(const overview_pixels &pixels,
+                                    QRgb color, int x, int y, int w, int h)
 {
-  QPainter p(pcanvas);
-  p.fillRect(x, y, w, h, overview_tile_color(ptile));
-  if (gui_options->overview.fog
-      && TILE_KNOWN_UNSEEN == client_tile_get_known(ptile)) {
-    p.fillRect(x, y, w, h, QColor(0, 0, 0, 128));
+  const QRect area = QRect(x, y, w, h) & pixels.rect;
+
+  for (int row = area.top(); row <= area.bottom(); row++) {
+    auto line =
+        reinterpret_cast<QRgb *>(pixels.bits + row * pixels.bytes_per_line);
+
+    std::fill(line + area.left(), line + area.right() + 1, color);
   }
-  p.end();
+
+  return area;
 }
 
 /**
-   Redraw the given map position in the overview canvas.
+   Draws the given map position into the backing store, and returns the
+   area of the overview that changed. Only writes to the overview rows of
+   the tile, so tiles of different rows can be drawn concurrently.
  */
-static void overview_update_tile(const tile *ptile)
+static QRect overview_draw_tile(const overview_pixels &pixels,
+                                const tile *ptile)
 {
-  if (!can_client_change_view()) {
-    return;
-  }
-
   int tile_x, tile_y;
+  QRect changed;
+  QRgb color = overview_tile_color(ptile).rgb();
+
+  if (gui_options->overview.fog
+      && TILE_KNOWN_UNSEEN == client_tile_get_known(ptile)) {
+    // Same as painting half transparent black over it.
+    color = qRgb(qRed(color) * 127 / 255, qGreen(color) * 127 / 255,
+                 qBlue(color) * 127 / 255);
+  }
 
   /* Base overview positions are just like natural positions, but scaled to
    * the overview tile dimensions. */
@@ -330,10 +407,9 @@ static void overview_update_tile(const tile *ptile)
         if (overview_x > gui_options->overview.width - OVERVIEW_TILE_WIDTH) {
           /* This tile is shown half on the left and half on the right
            * side of the overview.  So we have to draw it in two parts. */
-          put_overview_tile_area(gui_options->overview.map, ptile,
-                                 overview_x - gui_options->overview.width,
-                                 overview_y, OVERVIEW_TILE_WIDTH,
-                                 OVERVIEW_TILE_HEIGHT);
+          changed |= put_overview_tile_area(
+              pixels, color, overview_x - gui_options->overview.width,
+              overview_y, OVERVIEW_TILE_WIDTH, OVERVIEW_TILE_HEIGHT);
         }
       } else {
         /* Clip half tile left and right.
@@ -342,13 +418,26 @@ static void overview_update_tile(const tile *ptile)
       }
     }
 
-    put_overview_tile_area(gui_options->overview.map, ptile, overview_x,
-                           overview_y, OVERVIEW_TILE_WIDTH,
-                           OVERVIEW_TILE_HEIGHT);
-
-    dirty_overview();
+    changed |= put_overview_tile_area(pixels, color, overview_x,
+                                      overview_y, OVERVIEW_TILE_WIDTH,
+                                      OVERVIEW_TILE_HEIGHT);
   }
   do_in_natural_pos_end;
+
+  return changed;
+}
+
+/**
+   Redraw the given map position in the overview canvas.
+ */
+static void overview_update_tile(const tile *ptile)
+{
+  if (!can_client_change_view() || overview_image.isNull()) {
+    return;
+  }
+
+  overview_image_dirty |= overview_draw_tile(overview_pixels_get(), ptile);
+  dirty_overview();
 }
 
 /**
@@ -402,6 +491,11 @@ void calculate_overview_dimensions()
       new QPixmap(gui_options->overview.width, gui_options->overview.height);
   gui_options->overview.map->fill(
       get_color(tileset, COLOR_OVERVIEW_UNKNOWN));
+  overview_image =
+      QImage(gui_options->overview.width, gui_options->overview.height,
+             QImage::Format_RGB32);
+  overview_image.fill(get_color(tileset, COLOR_OVERVIEW_UNKNOWN));
+  overview_image_dirty = QRect();
 
   update_minimap();
   if (can_client_change_view()) {
@@ -450,6 +544,8 @@ void overview_free()
     gui_options->overview.map = nullptr;
     gui_options->overview.window = nullptr;
   }
+  overview_image = QImage();
+  overview_image_dirty = QRect();
   updates = nullptr;
 }
 
@@ -94,6 +94,7 @@
 #include "goto.h" // client_goto_init()
 #include "governor.h"
 #include "helpdlg.h"
+#include "map_updates_handler.h"
 #include "messagewin_common.h"
 #include "music.h"
 #include "options.h"
@@ -356,8 +357,9 @@ void handle_server_join_reply(bool you_can_join, const char *message,
 
     set_server_busy(false);
 
-    if (get_client_page() == PAGE_MAIN
-        || get_client_page() == PAGE_NETWORK) {
+    if (!client.session.resuming
+        && (get_client_page() == PAGE_MAIN
+            || get_client_page() == PAGE_NETWORK)) {
       set_client_page(PAGE_START);
     }
 
@@ -372,7 +374,9 @@ void handle_server_join_reply(bool you_can_join, const char *message,
       send_client_wants_hack(challenge_file);
     }
 
-    set_client_state(C_S_PREPARING);
+    if (!client.session.resuming) {
+      set_client_state(C_S_PREPARING);
+    }
   } else {
     output_window_printf(ftc_client,
                          _("You were rejected from the game: %s"), message);
@@ -382,6 +386,10 @@ void handle_server_join_reply(bool you_can_join, const char *message,
       qInfo(_("You were rejected from the game: %s"), message);
     }
 
+    if (client.session.resuming) {
+      // Give up the game we wanted to resume.
+      set_client_state(C_S_DISCONNECTED);
+    }
     set_client_page(PAGE_MAIN);
   }
   if (strcmp(s_capability, our_capability) == 0) {
@@ -393,6 +401,41 @@ void handle_server_join_reply(bool you_can_join, const char *message,
                        s_capability);
 }
 
+/**
+   Answer of the server when we asked to resume our session after losing
+   the connection. If it was resumed, we keep the game and the server only
+   sends what changed. Otherwise we start over as for a new connection.
+ */
+void handle_session_resume_reply(bool resumed)
+{
+  fc_assert_ret(client.session.resuming);
+
+  if (resumed) {
+    qDebug("Session resumed, waiting for the changes.");
+    return;
+  }
+
+  qDebug("Session not resumed.");
+  set_client_state(C_S_DISCONNECTED);
+  set_client_page(PAGE_START);
+  set_client_state(C_S_PREPARING);
+}
+
+/**
+   The server gives us the session to resume after losing the connection.
+   We have received every change it made until the stamp.
+ */
+void handle_session_info(const char *token, int stamp)
+{
+  if (client.session.resuming) {
+    client.session.resuming = false;
+    output_window_append(ftc_client, _("Reconnected to the server."));
+  }
+
+  sz_strlcpy(client.session.token, token);
+  client.session.stamp = stamp;
+}
+
 /**
    Handles a remove-city packet, used by the server to tell us any time a
    city is no longer there.
@@ -402,6 +445,10 @@ void handle_city_remove(int city_id)
   struct city *pcity = game_city_by_number(city_id);
   bool need_menus_update;
 
+  if (nullptr == pcity && client.session.resuming) {
+    // The server doesn't know which cities we had.
+    return;
+  }
   fc_assert_ret_msg(nullptr != pcity, "Bad city %d.", city_id);
 
   need_menus_update = (nullptr != get_focus_unit_on_tile(city_tile(pcity)));
@@ -428,9 +475,12 @@ void handle_unit_remove(int unit_id)
   bool need_economy_report_update;
 
   if (!punit) {
-    qCritical("Server wants us to remove unit id %d, "
-              "but we don't know about this unit!",
-              unit_id);
+    // When resuming, the server doesn't know which units we had.
+    if (!client.session.resuming) {
+      qCritical("Server wants us to remove unit id %d, "
+                "but we don't know about this unit!",
+                unit_id);
+    }
     return;
   }
 
@@ -2143,6 +2193,8 @@ void handle_map_info(int xsize, int ysize, int topology_id)
 
   map_init_topology();
   main_map_allocate();
+  // Tile indices now refer to other tiles.
+  freeciv::map_updates_handler::invalidate_all();
   client_player_maps_reset();
   init_client_goto();
   mapdeco_init();
@@ -3010,7 +3062,7 @@ void handle_tile_info(const struct packet_tile_info *packet)
   }
 
   if (!BV_ARE_EQUAL(ptile->extras, packet->extras)) {
-    ptile->extras = packet->extras;
+    tile_set_extras(ptile, &packet->extras);
     tile_changed = true;
   }
 
@@ -3179,7 +3231,7 @@ void handle_tile_info(const struct packet_tile_info *packet)
     unit_list_clear(ptile->units);
   }
 
-  ptile->continent = packet->continent;
+  tile_set_continent(ptile, packet->continent);
   wld.map.num_continents = MAX(ptile->continent, wld.map.num_continents);
 
   if (packet->label[0] == '\0') {
@@ -3417,6 +3469,9 @@ void handle_rulesets_ready()
   // Pre calculate action related data.
   actions_rs_pre_san_gen();
 
+  // Prepare effect requirements for evaluation.
+  ruleset_cache_compile();
+
   // Setup unit unknown move cost caches
   unit_type_iterate(ptype)
   {
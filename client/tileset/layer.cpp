@@ -14,6 +14,8 @@
 #include "layer.h"
 
 #include "control.h"
+#include "map.h"
+#include "map_updates_handler.h"
 #include "options.h"
 #include "tilespec.h"
 
@@ -73,6 +75,39 @@ bool layer::solid_background(const tile *ptile, const unit *punit,
   return do_draw_unit(ptile, punit) || (gui_options->draw_cities && pcity);
 }
 
+/**
+ * @brief Same as fill_sprite_array(), but reuses the sprites computed for
+ *        the tile by an earlier call when it hasn't changed since.
+ *
+ * Only tiles of the map are cached, and only for layers that are @ref
+ * is_cacheable. The returned reference is valid until the next call.
+ */
+const std::vector<drawn_sprite> &
+layer::fill_sprite_array_cached(const tile *ptile, const tile_edge *pedge,
+                                const tile_corner *pcorner,
+                                const unit *punit) const
+{
+  if (!is_cacheable() || ptile == nullptr || pedge != nullptr
+      || pcorner != nullptr || map_is_empty()
+      || ptile != wld.map.tiles + tile_index(ptile)) {
+    m_uncached = fill_sprite_array(ptile, pedge, pcorner, punit);
+    return m_uncached;
+  }
+
+  if (m_cache.size() != static_cast<size_t>(MAP_INDEX_SIZE)) {
+    m_cache.assign(MAP_INDEX_SIZE, cache_entry());
+  }
+
+  const auto version = map_updates_handler::tile_version(ptile);
+  auto &entry = m_cache[tile_index(ptile)];
+  if (entry.version != version || entry.punit != punit) {
+    entry.version = version;
+    entry.punit = punit;
+    entry.sprites = fill_sprite_array(ptile, pedge, pcorner, punit);
+  }
+  return entry.sprites;
+}
+
 /**
  * \brief Shortcut to load a sprite from the tileset.
  */
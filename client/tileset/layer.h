@@ -14,6 +14,9 @@
 
 #include "tileset/drawn_sprite.h"
 
+// std
+#include <vector>
+
 // Forward declarations
 class QPixmap;
 
@@ -179,6 +182,19 @@ class layer {
     return {};
   }
 
+  const std::vector<drawn_sprite> &
+  fill_sprite_array_cached(const tile *ptile, const tile_edge *pedge,
+                           const tile_corner *pcorner,
+                           const unit *punit) const;
+
+  /**
+   * Whether the sprites drawn on a tile only depend on the state of the
+   * tile and its neighbors (and on the client options). The results of
+   * such layers are cached by fill_sprite_array_cached(), and recomputed
+   * when map_updates_handler is told that the tile changed.
+   */
+  virtual bool is_cacheable() const { return false; }
+
   /**
    * Loads all sprites that do not depend on the ruleset.
    */
@@ -250,6 +266,15 @@ class layer {
 private:
   struct tileset *m_ts;
   mapview_layer m_layer;
+
+  /// Sprites computed for a tile by fill_sprite_array_cached()
+  struct cache_entry {
+    unsigned long version = 0; ///< The tile version, 0 if not computed
+    const unit *punit = nullptr;
+    std::vector<drawn_sprite> sprites;
+  };
+  mutable std::vector<cache_entry> m_cache; ///< Indexed by tile index
+  mutable std::vector<drawn_sprite> m_uncached;
 };
 
 } // namespace freeciv
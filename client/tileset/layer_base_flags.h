@@ -29,6 +29,8 @@ class layer_base_flags : public layer {
                     const tile_corner *pcorner,
                     const unit *punit) const override;
 
+  bool is_cacheable() const override { return true; }
+
 private:
   QPoint m_offset;
 };
@@ -58,6 +58,8 @@ class layer_darkness : public layer {
                     const tile_corner *pcorner,
                     const unit *punit) const override;
 
+  bool is_cacheable() const override { return true; }
+
 private:
   /**
    * Sets one of the sprites used to draw the darkness.
@@ -49,6 +49,8 @@ class layer_roads : public layer {
                     const tile_corner *pcorner,
                     const unit *punit) const override;
 
+  bool is_cacheable() const override { return true; }
+
   void reset_ruleset() override;
 
 private:
@@ -825,7 +825,8 @@ void put_one_element(QPixmap *pcanvas,
 {
   bool city_unit = false;
   int dummy_x, dummy_y;
-  auto sprites = layer->fill_sprite_array(ptile, pedge, pcorner, punit);
+  const auto &sprites =
+      layer->fill_sprite_array_cached(ptile, pedge, pcorner, punit);
   bool fog = (ptile && gui_options->draw_fog_of_war
               && TILE_KNOWN_UNSEEN == client_tile_get_known(ptile));
   if (punit) {
@@ -26,11 +26,9 @@ conn_loss_widget::conn_loss_widget(QWidget *parent) : QFrame(parent)
   ui.action->setText(_("Reconnect"));
 
   connect(ui.action, &QPushButton::pressed, [this] {
-    disconnect_from_server();
-
     // client_url() already contains the password.
     char errbuf[512];
-    if (connect_to_server(client_url(), errbuf, sizeof(errbuf)) >= 0) {
+    if (reconnect_to_server(errbuf, sizeof(errbuf)) >= 0) {
       // Success!
       setVisible(false);
     } else {
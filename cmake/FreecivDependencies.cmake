@@ -125,6 +125,18 @@ set(FREECIV_HAVE_ZSTD ${KArchive_HAVE_ZSTD})
 
 find_package(ZLIB REQUIRED) # Network protocol code
 
+# Faster network compression, used when both ends support it
+find_package(PkgConfig QUIET)
+if (PKG_CONFIG_FOUND)
+  pkg_check_modules(LIBZSTD IMPORTED_TARGET libzstd)
+endif()
+if (LIBZSTD_FOUND)
+  message(STATUS "Using zstd for network compression")
+  set(FREECIV_HAVE_LIBZSTD TRUE)
+else()
+  message(STATUS "libzstd not found - network compression uses zlib only")
+endif()
+
 # Some systems don't have a well-defined root user
 if (EMSCRIPTEN)
   set(ALWAYS_ROOT TRUE)
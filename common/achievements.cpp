@@ -209,17 +209,17 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
     max_unknown = (total * (100 - ach->value)) / 100;
     required = total - max_unknown;
 
-    whole_map_iterate(&(wld.map), ptile)
+    whole_map_index_iterate(&(wld.map), i)
     {
       bool this_is_known = false;
 
       if (is_server()) {
-        if (pplayer->tile_known->at(tile_index(ptile))) {
+        if (pplayer->tile_known->at(i)) {
           this_is_known = true;
         }
       } else {
         // Client
-        if (ptile->terrain != T_UNKNOWN) {
+        if (wld.map.hot->terrain[i] >= 0) {
           this_is_known = true;
         }
       }
@@ -236,7 +236,7 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
         }
       }
     }
-    whole_map_iterate_end;
+    whole_map_index_iterate_end;
   }
 
     return false;
@@ -303,17 +303,17 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
     std::vector<bool> seen(wld.map.num_continents);
     int count = 0;
 
-    whole_map_iterate(&(wld.map), ptile)
+    whole_map_index_iterate(&(wld.map), i)
     {
       bool this_is_known = false;
 
       if (is_server()) {
-        if (pplayer->tile_known->at(tile_index(ptile))) {
+        if (pplayer->tile_known->at(i)) {
           this_is_known = true;
         }
       } else {
         // Client
-        if (ptile->terrain != T_UNKNOWN) {
+        if (wld.map.hot->terrain[i] >= 0) {
           this_is_known = true;
         }
       }
@@ -321,15 +321,17 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
       if (this_is_known) {
         /* FIXME: This makes the assumption that fogged tiles belonged
          *        to their current continent when they were last seen. */
-        if (ptile->continent > 0 && !seen[ptile->continent - 1]) {
+        const Continent_id cont = map_hot_continent(&(wld.map), i);
+
+        if (cont > 0 && !seen[cont - 1]) {
           if (++count >= ach->value) {
             return true;
           }
-          seen[ptile->continent - 1] = true;
+          seen[cont - 1] = true;
         }
       }
     }
-    whole_map_iterate_end;
+    whole_map_index_iterate_end;
 
     return false;
   }
@@ -48,6 +48,25 @@
 #include <algorithm> // max, min
 #include <cmath>     // ceil, floor
 #include <cstdarg>   // va_*
+#include <cstdint>
+#include <unordered_map>
+
+/* Requirement results shared by the action enabler evaluations with the
+ * same actor and target. The actor requirements are evaluated against the
+ * target player too, so they can't be shared between targets. */
+struct action_req_cache {
+  std::unordered_map<std::uint64_t, enum fc_tristate> actor;
+  std::unordered_map<std::uint64_t, enum fc_tristate> target;
+};
+
+/* The requirement caches of action_probs_unit_vs_targets(), by target.
+ * The units at the target tile are cached by id. */
+struct action_batch {
+  struct action_req_cache city;
+  struct action_req_cache tile;
+  struct action_req_cache self;
+  std::unordered_map<int, struct action_req_cache> units;
+};
 
 // Custom data types for obligatory hard action requirements.
 
@@ -4220,6 +4239,69 @@ bool is_action_enabled_unit_on_self(const action_id wanted_action,
                                              unit_tile(actor_unit));
 }
 
+/**
+   Returns a key identifying the requirement in an action_req_cache.
+ */
+static std::uint64_t action_req_cache_key(const struct requirement *req)
+{
+  return (static_cast<std::uint64_t>(
+              static_cast<std::uint32_t>(universal_number(&req->source)))
+          << 32)
+         | (static_cast<std::uint64_t>(req->source.kind) << 16)
+         | (static_cast<std::uint64_t>(req->range) << 8)
+         | (req->survives ? 2 : 0) | (req->present ? 1 : 0);
+}
+
+/**
+   Same as mke_eval_reqs() with RPT_CERTAIN, but looks the results of the
+   requirements up in the cache first and stores the new ones there. The
+   cache must have been filled with the same parameters. It may be nullptr.
+ */
+static enum fc_tristate mke_eval_reqs_cached(
+    std::unordered_map<std::uint64_t, enum fc_tristate> *cache,
+    const struct player *pow_player, const struct player *target_player,
+    const struct player *other_player, const struct city *target_city,
+    const struct impr_type *target_building, const struct tile *target_tile,
+    const struct unit *target_unit, const struct output_type *target_output,
+    const struct specialist *target_specialist,
+    const struct requirement_vector *reqs)
+{
+  enum fc_tristate result = TRI_YES;
+
+  if (cache == nullptr) {
+    return mke_eval_reqs(pow_player, target_player, other_player,
+                         target_city, target_building, target_tile,
+                         target_unit, target_output, target_specialist,
+                         reqs, RPT_CERTAIN);
+  }
+
+  requirement_vector_iterate(reqs, preq)
+  {
+    const std::uint64_t key = action_req_cache_key(preq);
+    auto cached = cache->find(key);
+    enum fc_tristate current;
+
+    if (cached != cache->end()) {
+      current = cached->second;
+    } else {
+      current = mke_eval_req(pow_player, target_player, other_player,
+                             target_city, target_building, target_tile,
+                             target_unit, target_output, target_specialist,
+                             preq, RPT_CERTAIN);
+      cache->emplace(key, current);
+    }
+
+    if (current == TRI_NO) {
+      return TRI_NO;
+    } else if (current == TRI_MAYBE) {
+      result = TRI_MAYBE;
+    }
+  }
+  requirement_vector_iterate_end;
+
+  return result;
+}
+
 /**
    Find out if the action is enabled, may be enabled or isn't enabled given
    what the player owning the actor knowns.
@@ -4245,7 +4327,8 @@ static enum fc_tristate action_enabled_local(
     const struct player *target_player, const struct city *target_city,
     const struct impr_type *target_building, const struct tile *target_tile,
     const struct unit *target_unit, const struct output_type *target_output,
-    const struct specialist *target_specialist)
+    const struct specialist *target_specialist,
+    struct action_req_cache *cache)
 {
   enum fc_tristate current;
   enum fc_tristate result;
@@ -4255,13 +4338,16 @@ static enum fc_tristate action_enabled_local(
                               enabler)
   {
     current = fc_tristate_and(
-        mke_eval_reqs(actor_player, actor_player, target_player, actor_city,
-                      actor_building, actor_tile, actor_unit, actor_output,
-                      actor_specialist, &enabler->actor_reqs, RPT_CERTAIN),
-        mke_eval_reqs(actor_player, target_player, actor_player, target_city,
-                      target_building, target_tile, target_unit,
-                      target_output, target_specialist,
-                      &enabler->target_reqs, RPT_CERTAIN));
+        mke_eval_reqs_cached(
+            cache ? &cache->actor : nullptr, actor_player, actor_player,
+            target_player, actor_city, actor_building, actor_tile,
+            actor_unit, actor_output, actor_specialist,
+            &enabler->actor_reqs),
+        mke_eval_reqs_cached(
+            cache ? &cache->target : nullptr, actor_player, target_player,
+            actor_player, target_city, target_building, target_tile,
+            target_unit, target_output, target_specialist,
+            &enabler->target_reqs));
     if (current == TRI_YES) {
       return TRI_YES;
     } else if (current == TRI_MAYBE) {
@@ -4477,7 +4563,7 @@ static struct act_prob action_prob(
     const struct unit_type *target_unittype_p,
     const struct output_type *target_output,
     const struct specialist *target_specialist,
-    const struct extra_type *target_extra)
+    const struct extra_type *target_extra, struct action_req_cache *cache)
 {
   int known;
   struct act_prob chance;
@@ -4519,7 +4605,8 @@ static struct act_prob action_prob(
                            actor_building, actor_tile, actor_unit,
                            actor_output, actor_specialist, target_player,
                            target_city, target_building, target_tile,
-                           target_unit, target_output, target_specialist));
+                           target_unit, target_output, target_specialist,
+                           cache));
 
   switch (paction->result) {
   case ACTRES_SPY_POISON:
@@ -4761,7 +4848,7 @@ static struct act_prob action_prob(
 static struct act_prob action_prob_vs_city_full(
     const struct unit *actor_unit, const struct city *actor_home,
     const struct tile *actor_tile, const action_id act_id,
-    const struct city *target_city)
+    const struct city *target_city, struct action_batch *batch)
 {
   const struct impr_type *target_building;
   const struct unit_type *target_utype;
@@ -4819,7 +4906,8 @@ static struct act_prob action_prob_vs_city_full(
                      nullptr, actor_tile, actor_unit, nullptr, nullptr,
                      nullptr, actor_home, city_owner(target_city),
                      target_city, target_building, city_tile(target_city),
-                     nullptr, target_utype, nullptr, nullptr, nullptr);
+                     nullptr, target_utype, nullptr, nullptr, nullptr,
+                     batch ? &batch->city : nullptr);
 }
 
 /**
@@ -4831,8 +4919,8 @@ struct act_prob action_prob_vs_city(const struct unit *actor_unit,
                                     const struct city *target_city)
 {
   return action_prob_vs_city_full(actor_unit, unit_home(actor_unit),
-                                  unit_tile(actor_unit), act_id,
-                                  target_city);
+                                  unit_tile(actor_unit), act_id, target_city,
+                                  nullptr);
 }
 
 /**
@@ -4842,7 +4930,7 @@ struct act_prob action_prob_vs_city(const struct unit *actor_unit,
 static struct act_prob action_prob_vs_unit_full(
     const struct unit *actor_unit, const struct city *actor_home,
     const struct tile *actor_tile, const action_id act_id,
-    const struct unit *target_unit)
+    const struct unit *target_unit, struct action_batch *batch)
 {
   if (actor_unit == nullptr || target_unit == nullptr) {
     // Can't do an action when actor or target are missing.
@@ -4881,7 +4969,8 @@ static struct act_prob action_prob_vs_unit_full(
                      nullptr, actor_home, unit_owner(target_unit),
                      tile_city(unit_tile(target_unit)), nullptr,
                      unit_tile(target_unit), target_unit, nullptr, nullptr,
-                     nullptr, nullptr);
+                     nullptr, nullptr,
+                     batch ? &batch->units[target_unit->id] : nullptr);
 }
 
 /**
@@ -4893,8 +4982,8 @@ struct act_prob action_prob_vs_unit(const struct unit *actor_unit,
                                     const struct unit *target_unit)
 {
   return action_prob_vs_unit_full(actor_unit, unit_home(actor_unit),
-                                  unit_tile(actor_unit), act_id,
-                                  target_unit);
+                                  unit_tile(actor_unit), act_id, target_unit,
+                                  nullptr);
 }
 
 /**
@@ -4904,7 +4993,7 @@ struct act_prob action_prob_vs_unit(const struct unit *actor_unit,
 static struct act_prob action_prob_vs_units_full(
     const struct unit *actor_unit, const struct city *actor_home,
     const struct tile *actor_tile, const action_id act_id,
-    const struct tile *target_tile)
+    const struct tile *target_tile, struct action_batch *batch)
 {
   struct act_prob prob_all;
 
@@ -5011,7 +5100,7 @@ static struct act_prob action_prob_vs_units_full(
         actor_tile, actor_unit, nullptr, nullptr, nullptr, actor_home,
         unit_owner(target_unit), tile_city(unit_tile(target_unit)), nullptr,
         unit_tile(target_unit), target_unit, nullptr, nullptr, nullptr,
-        nullptr);
+        nullptr, batch ? &batch->units[target_unit->id] : nullptr);
 
     if (!action_prob_possible(prob_unit)) {
       // One unit makes it impossible for all units.
@@ -5052,7 +5141,7 @@ struct act_prob action_prob_vs_units(const struct unit *actor_unit,
 {
   return action_prob_vs_units_full(actor_unit, unit_home(actor_unit),
                                    unit_tile(actor_unit), act_id,
-                                   target_tile);
+                                   target_tile, nullptr);
 }
 
 /**
@@ -5062,7 +5151,8 @@ struct act_prob action_prob_vs_units(const struct unit *actor_unit,
 static struct act_prob action_prob_vs_tile_full(
     const struct unit *actor_unit, const struct city *actor_home,
     const struct tile *actor_tile, const action_id act_id,
-    const struct tile *target_tile, const struct extra_type *target_extra)
+    const struct tile *target_tile, const struct extra_type *target_extra,
+    struct action_batch *batch)
 {
   if (actor_unit == nullptr || target_tile == nullptr) {
     // Can't do an action when actor or target are missing.
@@ -5100,7 +5190,8 @@ static struct act_prob action_prob_vs_tile_full(
                      nullptr, actor_tile, actor_unit, nullptr, nullptr,
                      nullptr, actor_home, tile_owner(target_tile),
                      tile_city(target_tile), nullptr, target_tile, nullptr,
-                     nullptr, nullptr, nullptr, target_extra);
+                     nullptr, nullptr, nullptr, target_extra,
+                     batch ? &batch->tile : nullptr);
 }
 
 /**
@@ -5114,7 +5205,7 @@ struct act_prob action_prob_vs_tile(const struct unit *actor_unit,
 {
   return action_prob_vs_tile_full(actor_unit, unit_home(actor_unit),
                                   unit_tile(actor_unit), act_id, target_tile,
-                                  target_extra);
+                                  target_extra, nullptr);
 }
 
 /**
@@ -5124,7 +5215,8 @@ struct act_prob action_prob_vs_tile(const struct unit *actor_unit,
 static struct act_prob action_prob_self_full(const struct unit *actor_unit,
                                              const struct city *actor_home,
                                              const struct tile *actor_tile,
-                                             const action_id act_id)
+                                             const action_id act_id,
+                                             struct action_batch *batch)
 {
   if (actor_unit == nullptr) {
     // Can't do the action when the actor is missing.
@@ -5155,7 +5247,8 @@ static struct act_prob action_prob_self_full(const struct unit *actor_unit,
   return action_prob(act_id, unit_owner(actor_unit), tile_city(actor_tile),
                      nullptr, actor_tile, actor_unit, nullptr, nullptr,
                      nullptr, actor_home, nullptr, nullptr, nullptr, nullptr,
-                     nullptr, nullptr, nullptr, nullptr, nullptr);
+                     nullptr, nullptr, nullptr, nullptr, nullptr,
+                     batch ? &batch->self : nullptr);
 }
 
 /**
@@ -5166,7 +5259,106 @@ struct act_prob action_prob_self(const struct unit *actor_unit,
                                  const action_id act_id)
 {
   return action_prob_self_full(actor_unit, unit_home(actor_unit),
-                               unit_tile(actor_unit), act_id);
+                               unit_tile(actor_unit), act_id, nullptr);
+}
+
+/**
+   Fills in the actor unit's probabilities of successfully performing every
+   action it can do against the given targets, indexed by action id. Gives
+   the same results as calling action_prob_vs_city(), action_prob_vs_unit(),
+   action_prob_vs_units(), action_prob_vs_tile() and action_prob_self() for
+   each action, but evaluates the requirements shared by the action
+   enablers only once per target.
+
+   Actions that the unit can't do, that are out of range or that have no
+   target (target_tile is used for unit stack and tile targeted actions) are
+   impossible. Self targeted actions are only considered if vs_self is set.
+   Actions not performed by units are left alone.
+ */
+void action_probs_unit_vs_targets(const struct unit *actor_unit,
+                                  const struct city *target_city,
+                                  const struct unit *target_unit,
+                                  const struct tile *target_tile,
+                                  const struct extra_type *target_extra,
+                                  bool vs_self,
+                                  struct act_prob *probabilities)
+{
+  struct action_batch batch;
+  const struct city *actor_home;
+  const struct tile *actor_tile;
+  int distance[ATK_COUNT];
+  bool has_target[ATK_COUNT];
+
+  fc_assert_ret(actor_unit != nullptr);
+
+  actor_home = unit_home(actor_unit);
+  actor_tile = unit_tile(actor_unit);
+
+  has_target[ATK_CITY] = target_city != nullptr;
+  has_target[ATK_UNIT] = target_unit != nullptr;
+  has_target[ATK_UNITS] = target_tile != nullptr;
+  has_target[ATK_TILE] = target_tile != nullptr;
+  has_target[ATK_SELF] = vs_self;
+
+  distance[ATK_CITY] =
+      target_city ? real_map_distance(actor_tile, city_tile(target_city))
+                  : 0;
+  distance[ATK_UNIT] =
+      target_unit ? real_map_distance(actor_tile, unit_tile(target_unit))
+                  : 0;
+  distance[ATK_UNITS] =
+      target_tile ? real_map_distance(actor_tile, target_tile) : 0;
+  distance[ATK_TILE] = distance[ATK_UNITS];
+  distance[ATK_SELF] = 0;
+
+  action_iterate(act)
+  {
+    const enum action_target_kind tgt_kind = action_id_get_target_kind(act);
+
+    if (action_id_get_actor_kind(act) != AAK_UNIT) {
+      // Not relevant.
+      continue;
+    }
+
+    fc_assert_action(tgt_kind != ATK_COUNT,
+                     probabilities[act] = ACTPROB_IMPOSSIBLE;
+                     continue);
+
+    // Skip what can be ruled out without looking at the enablers.
+    if (!has_target[tgt_kind] || !unit_can_do_action(actor_unit, act)
+        || !action_id_distance_accepted(act, distance[tgt_kind])) {
+      probabilities[act] = ACTPROB_IMPOSSIBLE;
+      continue;
+    }
+
+    switch (tgt_kind) {
+    case ATK_CITY:
+      probabilities[act] = action_prob_vs_city_full(
+          actor_unit, actor_home, actor_tile, act, target_city, &batch);
+      break;
+    case ATK_UNIT:
+      probabilities[act] = action_prob_vs_unit_full(
+          actor_unit, actor_home, actor_tile, act, target_unit, &batch);
+      break;
+    case ATK_UNITS:
+      probabilities[act] = action_prob_vs_units_full(
+          actor_unit, actor_home, actor_tile, act, target_tile, &batch);
+      break;
+    case ATK_TILE:
+      probabilities[act] =
+          action_prob_vs_tile_full(actor_unit, actor_home, actor_tile, act,
+                                   target_tile, target_extra, &batch);
+      break;
+    case ATK_SELF:
+      probabilities[act] = action_prob_self_full(actor_unit, actor_home,
+                                                 actor_tile, act, &batch);
+      break;
+    case ATK_COUNT:
+      // Handled above.
+      break;
+    }
+  }
+  action_iterate_end;
 }
 
 /**
@@ -5251,7 +5443,7 @@ struct act_prob action_speculate_unit_on_city(const action_id act_id,
     }
   } else {
     return action_prob_vs_city_full(actor, actor_home, actor_tile, act_id,
-                                    target);
+                                    target, nullptr);
   }
 }
 
@@ -5281,7 +5473,7 @@ struct act_prob action_speculate_unit_on_units(action_id act_id,
     }
   } else {
     return action_prob_vs_units_full(actor, actor_home, actor_tile, act_id,
-                                     target);
+                                     target, nullptr);
   }
 }
 
@@ -5311,7 +5503,7 @@ struct act_prob action_speculate_unit_on_tile(
     }
   } else {
     return action_prob_vs_tile_full(actor, actor_home, actor_tile, act_id,
-                                    target_tile, target_extra);
+                                    target_tile, target_extra, nullptr);
   }
 }
 
@@ -5339,7 +5531,8 @@ struct act_prob action_speculate_unit_on_self(action_id act_id,
       return ACTPROB_IMPOSSIBLE;
     }
   } else {
-    return action_prob_self_full(actor, actor_home, actor_tile, act_id);
+    return action_prob_self_full(actor, actor_home, actor_tile, act_id,
+                                 nullptr);
   }
 }
 
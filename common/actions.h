@@ -450,6 +450,14 @@ struct act_prob action_prob_vs_tile(const struct unit *actor,
 struct act_prob action_prob_self(const struct unit *actor,
                                  const action_id act_id);
 
+void action_probs_unit_vs_targets(const struct unit *actor,
+                                  const struct city *target_city,
+                                  const struct unit *target_unit,
+                                  const struct tile *target_tile,
+                                  const struct extra_type *target_extra,
+                                  bool vs_self,
+                                  struct act_prob *probabilities);
+
 struct act_prob action_prob_unit_vs_tgt(const struct action *paction,
                                         const struct unit *act_unit,
                                         const struct city *tgt_city,
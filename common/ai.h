@@ -314,6 +314,13 @@ struct ai_type {
      */
     void (*unit_info)(struct unit *punit);
 
+    /* Called for player AI type before first_activities when the server
+     * plans AI players in parallel (the 'parallel_ai' setting). This runs
+     * in a worker thread, concurrently with the same call for the other
+     * players of the phase: it may only read the game state and write data
+     * owned by pplayer. */
+    void (*first_activities_plan)(struct player *pplayer);
+
     /* These are here reserving space for future optional callbacks.
      * This way we don't need to change the mandatory capability of the AI
      * module interface when adding such callbacks, but existing modules just
@@ -322,7 +329,6 @@ struct ai_type {
      * going to call these or is it too old version to do so. When mandatory
      * capability then changes again, please add new reservations to
      * replace those taken to use. */
-    void (*reserved_01)();
     void (*reserved_02)();
     void (*reserved_03)();
     void (*reserved_04)();
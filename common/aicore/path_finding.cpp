@@ -7,11 +7,13 @@
 // common
 #include "actions.h"
 #include "city.h"
+#include "extras.h"
 #include "fc_types.h"
 #include "map.h"
 #include "map_types.h"
 #include "movement.h"
 #include "player.h"
+#include "road.h"
 #include "terrain.h"
 #include "tile.h"
 #include "unit.h"
@@ -28,11 +30,14 @@
 // Qt
 #include <QDebug>
 #include <QHash>
+#include <QSet>
 #include <QString>
 #include <QtLogging> // qDebug, qWarning, qCricital, etc
 
 // std
+#include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 // For explanations on how to use this module, see "path_finding.h".
@@ -60,7 +65,7 @@ enum pf_mode {
 #endif // PF_DEBUG
 
 enum pf_node_status {
-  NS_UNINIT = 0, /* memory is calloced, hence zero means
+  NS_UNINIT = 0, /* nodes are reset to zero, hence zero means
                   * uninitialised. */
   NS_INIT,       /* node initialized, but we didn't search a route
                   * yet. */
@@ -212,6 +217,118 @@ static inline void pf_finalize_position(const struct pf_parameter *param,
 static void pf_position_fill_start_tile(struct pf_position *pos,
                                         const struct pf_parameter *param);
 
+// ========================== Node lattices ==============================
+
+// Number of released lattices kept around for reuse, per node type.
+#define PF_LATTICE_POOL_SIZE 4
+
+/**
+ * Storage for the nodes of a path-finding map.
+ *
+ * Allocating and zeroing one node per map tile for every pf_map used to
+ * dominate the cost of short searches on large maps. Instead, the node
+ * buffers are recycled through a small per-thread pool and every node is
+ * stamped with the generation of the map that last used it. A node whose
+ * stamp does not match the current generation is reset lazily when it is
+ * first accessed, so both setting up and releasing a lattice cost
+ * O(tiles visited) rather than O(map size).
+ */
+template <class Node> class pf_lattice {
+public:
+  pf_lattice();
+  ~pf_lattice();
+
+  /**
+   * Returns the node at the given map index, resetting it to its
+   * uninitialized (all-zero) state if this is the first access for this
+   * map.
+   */
+  inline Node *node(int index) const
+  {
+    if (m_buffer->stamps[index] != m_buffer->generation) {
+      m_buffer->stamps[index] = m_buffer->generation;
+      m_buffer->nodes[index] = Node();
+      m_buffer->visited.push_back(index);
+    }
+    return &m_buffer->nodes[index];
+  }
+
+  /**
+   * Returns the indices of all the nodes accessed since the lattice was
+   * created.
+   */
+  const std::vector<int> &visited() const { return m_buffer->visited; }
+
+private:
+  struct buffer {
+    std::vector<Node> nodes;
+    std::vector<unsigned> stamps;
+    std::vector<int> visited;
+    unsigned generation = 0;
+  };
+
+  static std::vector<std::unique_ptr<buffer>> &pool();
+
+  std::unique_ptr<buffer> m_buffer;
+};
+
+/**
+ * Returns the pool of released buffers for this node type. Each thread has
+ * its own pool, so that path-finding maps can be used concurrently.
+ */
+template <class Node>
+std::vector<std::unique_ptr<typename pf_lattice<Node>::buffer>> &
+pf_lattice<Node>::pool()
+{
+  static thread_local std::vector<std::unique_ptr<buffer>> released;
+  return released;
+}
+
+/**
+ * Takes a buffer from the pool, or allocates a new one if none of the
+ * released buffers fits the current map.
+ */
+template <class Node> pf_lattice<Node>::pf_lattice()
+{
+  const size_t size = MAP_INDEX_SIZE;
+  auto &released = pool();
+
+  while (!released.empty()) {
+    m_buffer = std::move(released.back());
+    released.pop_back();
+    if (m_buffer->nodes.size() == size) {
+      break;
+    }
+    // Stale buffer from a map of a different size.
+    m_buffer.reset();
+  }
+
+  if (!m_buffer) {
+    m_buffer = std::make_unique<buffer>();
+    m_buffer->nodes.resize(size);
+    m_buffer->stamps.resize(size, 0);
+  }
+
+  if (++m_buffer->generation == 0) {
+    // Wrapped around, old stamps could look current again.
+    std::fill(m_buffer->stamps.begin(), m_buffer->stamps.end(), 0);
+    m_buffer->generation = 1;
+  }
+}
+
+/**
+ * Gives the buffer back to the pool.
+ */
+template <class Node> pf_lattice<Node>::~pf_lattice()
+{
+  auto &released = pool();
+
+  m_buffer->visited.clear();
+  if (released.size() < PF_LATTICE_POOL_SIZE) {
+    released.push_back(std::move(m_buffer));
+  }
+}
+
 // ================ Specific pf_normal_* mode structures =================
 
 /* Normal path-finding maps are used for most of units with standard rules.
@@ -243,7 +360,12 @@ struct pf_normal_map {
   struct map_index_pq *queue;     /* Queue of nodes we have reached but not
                                    * processed yet (NS_NEW), sorted by their
                                    * total_CC. */
-  struct pf_normal_node *lattice; // Lattice of nodes.
+  pf_lattice<pf_normal_node> lattice; // Lattice of nodes.
+
+  struct tile *goal_tile; /* Tile towards which the search is directed
+                           * (A*), or nullptr to iterate the map in order
+                           * of increasing cost. */
+  int min_step_cost;      // Lower bound of the cost of a single move.
 };
 
 // Up-cast macro.
@@ -381,7 +503,7 @@ static void pf_normal_map_fill_position(const struct pf_normal_map *pfnm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pfnm->lattice.node(tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
 
 #ifdef PF_DEBUG
@@ -415,7 +537,7 @@ static void pf_normal_map_fill_position(const struct pf_normal_map *pfnm,
 static PFPath pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
                                            struct tile *dest_tile)
 {
-  struct pf_normal_node *node = pfnm->lattice + tile_index(dest_tile);
+  struct pf_normal_node *node = pfnm->lattice.node(tile_index(dest_tile));
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
   enum direction8 dir_next = direction8_invalid();
   struct tile *ptile;
@@ -437,7 +559,7 @@ static PFPath pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     }
 
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfnm->lattice + tile_index(ptile);
+    node = pfnm->lattice.node(tile_index(ptile));
   }
 
   // 2: Allocate the memory
@@ -445,7 +567,7 @@ static PFPath pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
 
   // 3: Backtrack again and fill the positions this time
   ptile = dest_tile;
-  node = pfnm->lattice + tile_index(ptile);
+  node = pfnm->lattice.node(tile_index(ptile));
 
   for (; i >= 0; i--) {
     pf_normal_map_fill_position(pfnm, ptile, &path[i]);
@@ -457,7 +579,7 @@ static PFPath pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     if (i > 0) {
       // Step further back, if we haven't finished yet
       ptile = mapstep(params->map, ptile, DIR_REVERSE(dir_next));
-      node = pfnm->lattice + tile_index(ptile);
+      node = pfnm->lattice.node(tile_index(ptile));
     }
   }
 
@@ -496,7 +618,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pfnm->lattice.node(tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
 
   // Processing Stage
@@ -510,7 +632,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
     /* Calculate the cost of every adjacent position and set them in the
      * priority queue for next call to pf_jumbo_map_iterate(). */
     int tindex1 = tile_index(tile1);
-    struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+    struct pf_normal_node *node1 = pfnm->lattice.node(tindex1);
     int priority, cost1, extra_cost1;
 
     /* As for the previous position, 'tile1', 'node1' and 'tindex1' are
@@ -559,16 +681,104 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pfnm->lattice.node(tindex)->status);
 #endif
 
   // Change the pf_map iterator. Node status step B. to C.
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pfnm->lattice.node(tindex)->status = NS_PROCESSED;
 
   return true;
 }
 
+/**
+   Lowest move cost any single step of the unit can have, according to the
+   ruleset. This is what map_move_cost() returns at best, with all the
+   roads and terrain bonuses the unit may use. Returns 0 if some moves may
+   be free, in which case no useful lower bound exists.
+ */
+static int pf_min_step_cost(const struct pf_parameter *params)
+{
+  const struct unit_class *pclass = utype_class(params->utype);
+  int min_cost = MIN(SINGLE_MOVE, params->utype->unknown_move_cost);
+
+  if (0 < params->move_rate) {
+    min_cost = MIN(min_cost, params->move_rate);
+  }
+  if (utype_has_flag(params->utype, UTYF_IGTER)) {
+    min_cost = MIN(min_cost, MOVE_COST_IGTER);
+  }
+  if (uclass_has_flag(pclass, UCF_TERRAIN_SPEED)) {
+    terrain_type_iterate(pterrain)
+    {
+      min_cost = MIN(min_cost, pterrain->movement_cost * SINGLE_MOVE);
+    }
+    terrain_type_iterate_end;
+
+    extra_type_list_iterate(pclass->cache.bonus_roads, pextra)
+    {
+      min_cost = MIN(min_cost, extra_road_get(pextra)->move_cost);
+    }
+    extra_type_list_iterate_end;
+  }
+
+  return MAX(min_cost, 0);
+}
+
+/**
+   Lower bound of the total move cost at which a unit having a total move
+   cost of 'cost' so far may reach a tile 'dist' steps away, if every step
+   costs at least 'step_cost'. This models the same truncation of the last
+   move of a turn as pf_normal_map_adjust_cost(), so that the bound never
+   decreases along a path and can be used as a consistent A* heuristic.
+ */
+static inline int pf_cost_lower_bound(const struct pf_parameter *params,
+                                      int cost, int dist, int step_cost)
+{
+  int move_rate = pf_move_rate(params);
+  int moves_left, steps, full_turns;
+
+  if (0 >= dist || 0 >= step_cost || 0 >= move_rate) {
+    return cost;
+  }
+
+  // Steps possible before the end of the current turn.
+  moves_left = pf_moves_left(params, cost);
+  steps = (moves_left + step_cost - 1) / step_cost;
+  if (dist <= steps) {
+    return cost + MIN(dist * step_cost, moves_left);
+  }
+  cost += moves_left;
+  dist -= steps;
+
+  // Then full turns.
+  steps = (move_rate + step_cost - 1) / step_cost;
+  full_turns = (dist - 1) / steps;
+  dist -= full_turns * steps;
+
+  return cost + full_turns * move_rate + MIN(dist * step_cost, move_rate);
+}
+
+/**
+   Priority of a node in the queue of a pf_normal_map: the cost of the path
+   to it, plus the estimated remaining cost to the goal tile when the
+   search is directed (A*).
+ */
+static inline int pf_normal_map_priority(const struct pf_normal_map *pfnm,
+                                         const struct tile *ptile,
+                                         int cost, int extra)
+{
+  const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
+
+  if (nullptr != pfnm->goal_tile) {
+    cost = pf_cost_lower_bound(params, cost,
+                               real_map_distance(ptile, pfnm->goal_tile),
+                               pfnm->min_step_cost);
+  }
+
+  return pf_total_CC(params, cost, extra);
+}
+
 /**
    Primary method for iterative path-finding.
 
@@ -590,7 +800,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pfnm->lattice.node(tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
   int cost_of_path;
   pf_move_scope scope = pf_move_scope(node->move_scope);
@@ -609,7 +819,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
       /* Calculate the cost of every adjacent position and set them in the
        * priority queue for next call to pf_normal_map_iterate(). */
       int tindex1 = tile_index(tile1);
-      struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+      struct pf_normal_node *node1 = pfnm->lattice.node(tindex1);
       int cost;
       int extra = 0;
 
@@ -691,7 +901,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         // As we prefer lower costs, let's reverse the cost of the path.
-        map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_insert(pfnm->queue, tindex1,
+                            -pf_normal_map_priority(pfnm, tile1, cost,
+                                                    extra));
       } else if (cost_of_path
                  < pf_total_CC(params, node1->cost, node1->extra_cost)) {
         /* We found a better route to 'tile1'. Let's register 'tindex1' to
@@ -701,7 +913,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         // As we prefer lower costs, let's reverse the cost of the path.
-        map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_replace(pfnm->queue, tindex1,
+                             -pf_normal_map_priority(pfnm, tile1, cost,
+                                                     extra));
       }
     }
     adjc_dir_iterate_end;
@@ -714,12 +928,12 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pfnm->lattice.node(tindex)->status);
 #endif
 
   // Change the pf_map iterator. Node status step C. to D.
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pfnm->lattice.node(tindex)->status = NS_PROCESSED;
 
   return true;
 }
@@ -731,7 +945,7 @@ static inline bool pf_normal_map_iterate_until(struct pf_normal_map *pfnm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfnm);
-  struct pf_normal_node *node = pfnm->lattice + tile_index(ptile);
+  struct pf_normal_node *node = pfnm->lattice.node(tile_index(ptile));
 
   if (nullptr == pf_map_parameter(pfm)->get_costs) {
     // Start position is handled in every function calling this function.
@@ -770,7 +984,7 @@ static int pf_normal_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_normal_map_iterate_until(pfnm, ptile)) {
-    return (pfnm->lattice[tile_index(ptile)].cost
+    return (pfnm->lattice.node(tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -823,7 +1037,6 @@ static void pf_normal_map_destroy(struct pf_map *pfm)
 {
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
 
-  delete[] pfnm->lattice;
   map_index_pq_destroy(pfnm->queue);
   delete pfnm;
 }
@@ -855,8 +1068,9 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
 #endif // PF_DEBUG
 
   // Allocate the map.
-  pfnm->lattice = new pf_normal_node[MAP_INDEX_SIZE]();
   pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  pfnm->goal_tile = nullptr;
+  pfnm->min_step_cost = 0;
 
   // Copy parameters.
   *params = *parameter;
@@ -873,7 +1087,7 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
   }
 
   // Initialise starting node.
-  node = pfnm->lattice + tile_index(params->start_tile);
+  node = pfnm->lattice.node(tile_index(params->start_tile));
   if (nullptr == params->get_costs) {
     if (!pf_normal_node_init(pfnm, node, params->start_tile, PF_MS_NONE)) {
       // Always fails.
@@ -957,7 +1171,7 @@ struct pf_danger_map {
                                * processed yet (NS_NEW and NS_WAITING),
                                * sorted by their total_CC. */
   struct map_index_pq *danger_queue; // Dangerous positions.
-  struct pf_danger_node *lattice;    // Lattice of nodes.
+  pf_lattice<pf_danger_node> lattice; // Lattice of nodes.
 };
 
 // Up-cast macro.
@@ -1098,7 +1312,7 @@ static void pf_danger_map_fill_position(const struct pf_danger_map *pfdm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pfdm->lattice.node(tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
 
 #ifdef PF_DEBUG
@@ -1154,7 +1368,7 @@ static PFPath pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
   enum direction8 dir_next = direction8_invalid();
   struct pf_danger_node::pf_danger_pos *danger_seg = nullptr;
   bool waited = false;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pfdm->lattice.node(tile_index(ptile));
   int length = 1;
   struct tile *iter_tile = ptile;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
@@ -1191,7 +1405,7 @@ static PFPath pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     // Step backward.
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pfdm->lattice.node(tile_index(iter_tile));
   }
 
   // Allocate memory for path.
@@ -1199,7 +1413,7 @@ static PFPath pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
   // Reset variables for main iteration.
   iter_tile = ptile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pfdm->lattice.node(tile_index(ptile));
   danger_seg = nullptr;
   waited = false;
 
@@ -1281,7 +1495,7 @@ static PFPath pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     // 5: Step further back.
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pfdm->lattice.node(tile_index(iter_tile));
   }
 
   fc_assert_msg(false, "Cannot get to the starting point!");
@@ -1310,7 +1524,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
                                          struct pf_danger_node *node1)
 {
   struct tile *ptile = PF_MAP(pfdm)->tile;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pfdm->lattice.node(tile_index(ptile));
   struct pf_danger_node::pf_danger_pos *pos;
   int length = 0, i;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
@@ -1326,7 +1540,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
          && direction8_is_valid(direction8(node->dir_to_here))) {
     length++;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pfdm->lattice.node(tile_index(ptile));
   }
 
   // Allocate memory for segment
@@ -1334,7 +1548,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
   // Reset tile and node pointers for main iteration
   ptile = PF_MAP(pfdm)->tile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pfdm->lattice.node(tile_index(ptile));
 
   // Now fill the positions
   for (i = 0, pos = node1->danger_segment; i < length; i++, pos++) {
@@ -1349,7 +1563,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
     // Step further down the tree
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pfdm->lattice.node(tile_index(ptile));
   }
 
 #ifdef PF_DEBUG
@@ -1424,7 +1638,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pfdm->lattice.node(tindex);
   pf_move_scope scope = pf_move_scope(node->move_scope);
 
   /* The previous position is defined by 'tile' (tile pointer), 'node'
@@ -1465,7 +1679,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_danger_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_danger_node *node1 = pfdm->lattice + tindex1;
+        struct pf_danger_node *node1 = pfdm->lattice.node(tindex1);
         int cost;
         int extra = 0;
 
@@ -1632,7 +1846,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       // Change the pf_map iterator and reset data.
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pfdm->lattice.node(tindex);
     } else {
       // No dangerous nodes to process, go for a safe one.
       if (!map_index_pq_remove(pfdm->queue, &tindex)) {
@@ -1641,13 +1855,13 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       }
 
 #ifdef PF_DEBUG
-      fc_assert(NS_PROCESSED != pfdm->lattice[tindex].status);
+      fc_assert(NS_PROCESSED != pfdm->lattice.node(tindex)->status);
 #endif
 
       // Change the pf_map iterator and reset data.
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pfdm->lattice.node(tindex);
       if (NS_WAITING != node->status) {
         // Node status step C. and D.
 #ifdef PF_DEBUG
@@ -1684,7 +1898,7 @@ static inline bool pf_danger_map_iterate_until(struct pf_danger_map *pfdm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfdm);
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pfdm->lattice.node(tile_index(ptile));
 
   // Start position is handled in every function calling this function.
 
@@ -1723,7 +1937,7 @@ static int pf_danger_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_danger_map_iterate_until(pfdm, ptile)) {
-    return (pfdm->lattice[tile_index(ptile)].cost
+    return (pfdm->lattice.node(tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -1775,15 +1989,14 @@ static bool pf_danger_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_danger_map_destroy(struct pf_map *pfm)
 {
   struct pf_danger_map *pfdm = PF_DANGER_MAP(pfm);
-  struct pf_danger_node *node;
-  int i;
 
   // Need to clean up the dangling danger segments.
-  for (i = 0, node = pfdm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
+  for (int tindex : pfdm->lattice.visited()) {
+    struct pf_danger_node *node = pfdm->lattice.node(tindex);
+
     delete[] node->danger_segment;
     node->danger_segment = nullptr;
   }
-  delete[] pfdm->lattice;
   map_index_pq_destroy(pfdm->queue);
   map_index_pq_destroy(pfdm->danger_queue);
   delete pfdm;
@@ -1808,7 +2021,6 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
 #endif // PF_DEBUG
 
   // Allocate the map.
-  pfdm->lattice = new pf_danger_node[MAP_INDEX_SIZE]();
   pfdm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
   pfdm->danger_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
 
@@ -1832,7 +2044,7 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_danger_map_iterate;
 
   // Initialise starting node.
-  node = pfdm->lattice + tile_index(params->start_tile);
+  node = pfdm->lattice.node(tile_index(params->start_tile));
   if (!pf_danger_node_init(pfdm, node, params->start_tile, PF_MS_NONE)) {
     // Always fails.
     fc_assert(
@@ -1925,7 +2137,7 @@ struct pf_fuel_map {
                                * total_CC */
   struct map_index_pq *waited_queue; /* Queue of nodes to reach farer
                                       * positions after having refueled. */
-  struct pf_fuel_node *lattice;      // Lattice of nodes
+  pf_lattice<pf_fuel_node> lattice;  // Lattice of nodes
 };
 
 // Up-cast macro.
@@ -2212,7 +2424,7 @@ static void pf_fuel_map_fill_position(const struct pf_fuel_map *pffm,
                                       struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pffm->lattice.node(tindex);
   struct pf_fuel_pos *head = node->segment;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pffm));
 
@@ -2252,7 +2464,7 @@ static PFPath pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
                                          struct tile *ptile)
 {
   enum direction8 dir_next = direction8_invalid();
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pffm->lattice.node(tile_index(ptile));
   struct pf_fuel_pos *segment = node->segment;
   int length = 1;
   struct tile *iter_tile = ptile;
@@ -2283,7 +2495,7 @@ static PFPath pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
     // Step backward.
     iter_tile =
         mapstep(params->map, iter_tile, DIR_REVERSE(segment->dir_to_here));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pffm->lattice.node(tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(nullptr != segment);
@@ -2299,7 +2511,7 @@ static PFPath pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
   // Reset variables for main iteration.
   iter_tile = ptile;
-  node = pffm->lattice + tile_index(ptile);
+  node = pffm->lattice.node(tile_index(ptile));
   segment = node->segment;
 
   for (i = length - 1; i >= 0; i--) {
@@ -2352,7 +2564,7 @@ static PFPath pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
     // 5: Step further back.
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pffm->lattice.node(tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(nullptr != segment);
@@ -2394,7 +2606,7 @@ static inline void pf_fuel_map_create_segment(struct pf_fuel_map *pffm,
   do {
     next = pos;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pffm->lattice + tile_index(ptile);
+    node = pffm->lattice.node(tile_index(ptile));
     pos = node->pos;
     if (nullptr != pos) {
       if (pos->cost == node->cost && pos->dir_to_here == node->dir_to_here
@@ -2500,7 +2712,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pffm->lattice.node(tindex);
   enum pf_move_scope scope = pf_move_scope(node->move_scope);
   int priority, waited_priority;
   bool waited = false;
@@ -2545,7 +2757,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_fuel_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_fuel_node *node1 = pffm->lattice + tindex1;
+        struct pf_fuel_node *node1 = pffm->lattice.node(tindex1);
         int cost, extra = 0;
         int moves_left;
         int cost_of_path, old_cost_of_path;
@@ -2784,7 +2996,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       // Change the pf_map iterator and reset data.
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pffm->lattice.node(tindex);
       waited = true;
 #ifdef PF_DEBUG
       fc_assert(0 < node->moves_left_req);
@@ -2802,7 +3014,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       // Change the pf_map iterator and reset data.
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pffm->lattice.node(tindex);
 
 #ifdef PF_DEBUG
       fc_assert(NS_PROCESSED != node->status);
@@ -2851,7 +3063,7 @@ static inline bool pf_fuel_map_iterate_until(struct pf_fuel_map *pffm,
                                              struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pffm);
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pffm->lattice.node(tile_index(ptile));
 
   // Start position is handled in every function calling this function.
 
@@ -2889,7 +3101,7 @@ static int pf_fuel_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_fuel_map_iterate_until(pffm, ptile)) {
-    const struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+    const struct pf_fuel_node *node = pffm->lattice.node(tile_index(ptile));
 
     return (node->segment->cost - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
@@ -2942,15 +3154,14 @@ static bool pf_fuel_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_fuel_map_destroy(struct pf_map *pfm)
 {
   struct pf_fuel_map *pffm = PF_FUEL_MAP(pfm);
-  struct pf_fuel_node *node;
-  int i;
 
   // Need to clean up the dangling fuel segments.
-  for (i = 0, node = pffm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
+  for (int tindex : pffm->lattice.visited()) {
+    struct pf_fuel_node *node = pffm->lattice.node(tindex);
+
     pf_fuel_pos_unref(node->pos);
     pf_fuel_pos_unref(node->segment);
   }
-  delete pffm->lattice;
   map_index_pq_destroy(pffm->queue);
   map_index_pq_destroy(pffm->waited_queue);
   delete pffm;
@@ -2984,7 +3195,6 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
 #endif // PF_DEBUG
 
   // Allocate the map.
-  pffm->lattice = new pf_fuel_node[MAP_INDEX_SIZE]();
   pffm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
   pffm->waited_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
 
@@ -2999,7 +3209,7 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_fuel_map_iterate;
 
   // Initialise starting node.
-  node = pffm->lattice + tile_index(params->start_tile);
+  node = pffm->lattice.node(tile_index(params->start_tile));
   if (!pf_fuel_node_init(pffm, node, params->start_tile, PF_MS_NONE)) {
     // Always fails.
     fc_assert(
@@ -3057,6 +3267,42 @@ struct pf_map *pf_map_new(const struct pf_parameter *parameter)
   return pf_normal_map_new(parameter);
 }
 
+/**
+   Factory function to create a new map directed towards 'goal_tile'. The
+   map iterates the tiles which are the most likely to lead to the goal
+   first (A* search), so that asking for the path, position or move cost
+   of 'goal_tile' usually explores far fewer tiles than with pf_map_new().
+   The costs of the tiles reached are the same as with pf_map_new(), but
+   the tiles are not iterated in order of increasing cost.
+
+   The estimate assumes moves cost at least what map_move_cost() can
+   return for the unit type. When it cannot be made (extra costs, jumbo,
+   danger or fuel maps), this is the same as pf_map_new().
+ */
+struct pf_map *pf_map_new_goal(const struct pf_parameter *parameter,
+                               struct tile *goal_tile)
+{
+  struct pf_map *pfm = pf_map_new(parameter);
+  struct pf_normal_map *pfnm;
+  int min_step_cost;
+
+  if (nullptr == pfm || nullptr == goal_tile
+      || nullptr != parameter->is_pos_dangerous
+      || nullptr != parameter->get_moves_left_req
+      || nullptr != parameter->get_costs || nullptr != parameter->get_EC) {
+    return pfm;
+  }
+
+  min_step_cost = pf_min_step_cost(parameter);
+  if (0 < min_step_cost) {
+    pfnm = PF_NORMAL_MAP(pfm);
+    pfnm->goal_tile = goal_tile;
+    pfnm->min_step_cost = min_step_cost;
+  }
+
+  return pfm;
+}
+
 /**
    After usage the map must be destroyed.
  */
@@ -3343,8 +3589,11 @@ QDebug &operator<<(QDebug &logger, const PFPath &path)
 // ===================== pf_reverse_map functions ========================
 
 /* The path-finding reverse maps are used check the move costs that the
- * units needs to reach the start tile. It stores a pf_map for every unit
- * type. */
+ * units needs to reach the start tile. A reverse map may have several
+ * target tiles, e.g. all the cities of a player. Units which move alike
+ * from the same tile share one iteration, which finds all the targets
+ * within the turn limit at once. The positions are kept for every kind
+ * of unit. */
 
 static const enum unit_type_flag_id signifiant_flags[3] = {
     UTYF_IGTER, UTYF_CIVILIAN, UTYF_COAST_STRICT};
@@ -3386,15 +3635,42 @@ inline bool operator==(const pf_parameter &e1, const pf_parameter &e2)
   return true;
 }
 
+/**
+   Hash function for the parameters of reverse maps, consistent with the
+   equality operator above.
+ */
+inline size_t qHash(const pf_parameter &param, size_t seed = 0)
+{
+  return qHashMulti(seed, param.start_tile, param.move_rate,
+                    utype_class(param.utype));
+}
+
 // The reverse map structure.
 struct pf_reverse_map {
   struct tile *target_tile;            // Where we want to go.
+  QSet<const struct tile *> targets;   // All the tiles we want to go.
   int max_turns;                       // The maximum of turns.
   struct pf_parameter template_params; // Keep a parameter ready for usage.
-  QHash<const pf_parameter *, struct pf_position *>
-      *hash; // A hash where pf_position are stored.
+  // The positions at the targets, for every kind of unit.
+  QHash<pf_parameter, QHash<const struct tile *, struct pf_position>>
+      positions;
 };
 
+/**
+   Consider every target tile of the reverse map as attackable, notably for
+   transports. See pf_reverse_get_action() in pf_tools.cpp.
+ */
+static enum pf_action
+pf_reverse_map_get_action(const struct tile *ptile, enum known_type known,
+                          const struct pf_parameter *param)
+{
+  Q_UNUSED(known)
+  const auto *targets =
+      static_cast<const QSet<const struct tile *> *>(param->data);
+
+  return (targets->contains(ptile) ? PF_ACTION_ATTACK : PF_ACTION_NONE);
+}
+
 /**
    'pf_reverse_map' constructor. If 'max_turns' is positive, then it won't
    try to iterate the maps beyond this number of turns.
@@ -3408,6 +3684,7 @@ struct pf_reverse_map *pf_reverse_map_new(const struct player *pplayer,
   struct pf_parameter *param = &pfrm->template_params;
 
   pfrm->target_tile = target_tile;
+  pfrm->targets.insert(target_tile);
   pfrm->max_turns = max_turns;
 
   // Initialize the parameter.
@@ -3415,9 +3692,8 @@ struct pf_reverse_map *pf_reverse_map_new(const struct player *pplayer,
   param->owner = pplayer;
   param->omniscience = omniscient;
   param->map = map;
-
-  // Initialize the map hash.
-  pfrm->hash = new QHash<const pf_parameter *, struct pf_position *>;
+  param->get_action = pf_reverse_map_get_action;
+  param->data = &pfrm->targets;
 
   return pfrm;
 }
@@ -3441,81 +3717,79 @@ pf_reverse_map_new_for_city(const struct city *pcity,
 void pf_reverse_map_destroy(struct pf_reverse_map *pfrm)
 {
   fc_assert_ret(nullptr != pfrm);
-  QHash<const pf_parameter *, pf_position *>::const_iterator it =
-      pfrm->hash->constBegin();
-  while (it != pfrm->hash->constEnd()) {
-    delete it.key();
-    delete it.value();
-    ++it;
-  }
-  delete pfrm->hash;
+
   delete pfrm;
 }
 
 /**
-   Returns the map for the unit type. Creates it if needed. Returns nullptr
-   if 'target_tile' is unreachable.
+   Add a target tile to the reverse map. All the targets are searched in
+   the same iterations, so this is much cheaper than another reverse map.
+   Targets must be added before the first query.
  */
-static const struct pf_position *
-pf_reverse_map_pos(struct pf_reverse_map *pfrm,
-                   const struct pf_parameter *param)
+void pf_reverse_map_add_target(struct pf_reverse_map *pfrm,
+                               struct tile *ptile)
 {
-  struct pf_position *pos;
-  struct pf_map *pfm;
-  struct pf_parameter *copy;
-  struct tile *target_tile;
-  const struct pf_normal_node *lattice;
-  int max_cost;
+  fc_assert_ret(nullptr != pfrm);
+  fc_assert_ret(pfrm->positions.isEmpty());
 
-  // Check if we already processed something similar.
-  if (pfrm->hash->contains(param)) {
-    pos = pfrm->hash->value(param);
-    return pos;
-  }
-
-  // We didn't. Build map and iterate.
-  pfm = pf_normal_map_new(param);
-  lattice = PF_NORMAL_MAP(pfm)->lattice;
-  target_tile = pfrm->target_tile;
-  if (pfrm->max_turns >= 0) {
-    max_cost = param->move_rate * (pfrm->max_turns + 1);
-    do {
-      if (lattice[tile_index(pfm->tile)].cost >= max_cost) {
+  pfrm->targets.insert(ptile);
+}
+
+/**
+   Iterate a map for the unit described by 'param' and return its
+   positions at the targets it reaches within the turn limit.
+ */
+static QHash<const struct tile *, struct pf_position>
+pf_reverse_map_iterate(const struct pf_reverse_map *pfrm,
+                       const struct pf_parameter *param)
+{
+  QHash<const struct tile *, struct pf_position> found;
+  struct pf_map *pfm = pf_normal_map_new(param);
+  const pf_lattice<pf_normal_node> *lattice = &PF_NORMAL_MAP(pfm)->lattice;
+  const int max_cost = (pfrm->max_turns >= 0
+                            ? param->move_rate * (pfrm->max_turns + 1)
+                            : FC_INFINITY);
+
+  do {
+    if (lattice->node(tile_index(pfm->tile))->cost >= max_cost) {
+      break;
+    } else if (pfrm->targets.contains(pfm->tile)) {
+      struct pf_position pos;
+
+      pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), pfm->tile, &pos);
+      found.insert(pfm->tile, pos);
+      if (found.size() == pfrm->targets.size()) {
+        // Nothing left to look for.
         break;
-      } else if (pfm->tile == target_tile) {
-        // Found our position. Insert in hash, destroy map, and return.
-        pos = new pf_position;
-        pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), target_tile, pos);
-        copy = new pf_parameter;
-        *copy = *param;
-        pfrm->hash->insert(copy, pos);
-        pf_map_destroy(pfm);
-        return pos;
       }
-    } while (pfm->iterate(pfm));
-  } else {
-    // No limit for iteration.
-    do {
-      if (pfm->tile == target_tile) {
-        // Found our position. Insert in hash, destroy map, and return.
-        pos = new pf_position;
-        pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), target_tile, pos);
-        copy = new pf_parameter;
-        *copy = *param;
-        pfrm->hash->insert(copy, pos);
-        pf_map_destroy(pfm);
-        return pos;
-      }
-    } while (pfm->iterate(pfm));
-  }
+    }
+  } while (pfm->iterate(pfm));
   pf_map_destroy(pfm);
 
-  /* Position not found. Let's insert nullptr as position to avoid to iterate
-   * the map again. */
-  copy = new pf_parameter;
-  *copy = *param;
-  pfrm->hash->insert(copy, nullptr);
-  return nullptr;
+  return found;
+}
+
+/**
+   Returns the position at 'target_tile' for the unit described by
+   'param'. Iterates the map if needed. Returns nullptr if 'target_tile' is
+   unreachable.
+ */
+static const struct pf_position *
+pf_reverse_map_pos(struct pf_reverse_map *pfrm,
+                   const struct pf_parameter *param,
+                   const struct tile *target_tile)
+{
+  // Check if we already processed something similar.
+  auto it = pfrm->positions.constFind(*param);
+
+  if (it == pfrm->positions.constEnd()) {
+    // We didn't. Build map and iterate.
+    it = pfrm->positions.insert(*param, pf_reverse_map_iterate(pfrm, param));
+  }
+
+  auto pos = it->constFind(target_tile);
+
+  return (pos != it->constEnd() ? &*pos : nullptr);
 }
 
 /**
@@ -3524,10 +3798,13 @@ pf_reverse_map_pos(struct pf_reverse_map *pfrm,
  */
 static inline const struct pf_position *
 pf_reverse_map_unit_pos(struct pf_reverse_map *pfrm,
-                        const struct unit *punit)
+                        const struct unit *punit,
+                        const struct tile *target_tile)
 {
   struct pf_parameter *param = &pfrm->template_params;
 
+  fc_assert_ret_val(pfrm->targets.contains(target_tile), nullptr);
+
   // Fill parameter.
   param->start_tile = unit_tile(punit);
   param->move_rate = unit_move_rate(punit);
@@ -3536,7 +3813,7 @@ pf_reverse_map_unit_pos(struct pf_reverse_map *pfrm,
    * have its whole move rate. */
   param->moves_left_initially = param->move_rate;
   param->utype = unit_type_get(punit);
-  return pf_reverse_map_pos(pfrm, param);
+  return pf_reverse_map_pos(pfrm, param, target_tile);
 }
 
 /**
@@ -3546,7 +3823,8 @@ pf_reverse_map_unit_pos(struct pf_reverse_map *pfrm,
 int pf_reverse_map_unit_move_cost(struct pf_reverse_map *pfrm,
                                   const struct unit *punit)
 {
-  const struct pf_position *pos = pf_reverse_map_unit_pos(pfrm, punit);
+  const struct pf_position *pos =
+      pf_reverse_map_unit_pos(pfrm, punit, pfrm->target_tile);
 
   return (pos != nullptr ? pos->total_MC : PF_IMPOSSIBLE_MC);
 }
@@ -3558,7 +3836,21 @@ bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
                                   const struct unit *punit,
                                   struct pf_position *pos)
 {
-  const struct pf_position *mypos = pf_reverse_map_unit_pos(pfrm, punit);
+  return pf_reverse_map_unit_position_to(pfrm, punit, pfrm->target_tile,
+                                         pos);
+}
+
+/**
+   Fill the position of the unit at 'ptile', which must be one of the
+   targets of the reverse map. Return TRUE if the tile is reachable.
+ */
+bool pf_reverse_map_unit_position_to(struct pf_reverse_map *pfrm,
+                                     const struct unit *punit,
+                                     const struct tile *ptile,
+                                     struct pf_position *pos)
+{
+  const struct pf_position *mypos =
+      pf_reverse_map_unit_pos(pfrm, punit, ptile);
 
   if (mypos != nullptr) {
     *pos = *mypos;
@@ -182,6 +182,11 @@
  *
  * You may call pf_map_path() multiple times with the same pfm.
  *
+ * When there is only one goal, create the map with pf_map_new_goal()
+ * instead. The search is then directed towards the goal (A*) and stops
+ * much earlier. The costs are the same, but such a map should not be used
+ * for the iteration of B).
+ *
  * B) the caller doesn't know the map position of the goal yet (but knows
  * what he is looking for, e.g. a port) and wants to iterate over
  * all paths in order of increasing costs (total_CC):
@@ -468,6 +473,9 @@ struct pf_reverse_map;
 // Create and free.
 struct pf_map *
 pf_map_new(const struct pf_parameter *parameter) fc__warn_unused_result;
+struct pf_map *
+pf_map_new_goal(const struct pf_parameter *parameter,
+                struct tile *goal_tile) fc__warn_unused_result;
 void pf_map_destroy(struct pf_map *pfm);
 
 // Method A) functions.
@@ -496,12 +504,18 @@ struct pf_reverse_map *pf_reverse_map_new_for_city(
     const struct city *pcity, const struct player *attacker, int max_turns,
     bool omniscient, const struct civ_map *map) fc__warn_unused_result;
 void pf_reverse_map_destroy(struct pf_reverse_map *prfm);
+void pf_reverse_map_add_target(struct pf_reverse_map *pfrm,
+                               struct tile *ptile);
 
 int pf_reverse_map_unit_move_cost(struct pf_reverse_map *pfrm,
                                   const struct unit *punit);
 bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
                                   const struct unit *punit,
                                   struct pf_position *pos);
+bool pf_reverse_map_unit_position_to(struct pf_reverse_map *pfrm,
+                                     const struct unit *punit,
+                                     const struct tile *ptile,
+                                     struct pf_position *pos);
 
 /* This macro iterates all reachable tiles.
  *
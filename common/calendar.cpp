@@ -88,6 +88,7 @@ void game_advance_year()
 {
   game_next_year(&game.info);
   game.info.turn++;
+  effect_cache_invalidate();
 }
 
 /**
@@ -5,6 +5,7 @@
 #include "capstr.h"
 
 // generated
+#include <fc_config.h>
 #include <fc_version.h>
 
 // utility
@@ -81,4 +82,11 @@ void init_our_capability()
     s = NETWORK_CAPSTRING;
   }
   sz_strlcpy(our_capability_internal, s);
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  // Optional, depends on the build.
+  if (!getenv("FREECIV_CAPS")) {
+    sz_strlcat(our_capability_internal, " " ZSTD_STREAM_CAPABILITY);
+  }
+#endif
 }
@@ -3,6 +3,10 @@
 
 #pragma once
 
+/* Optional capability: the executable can decode packets compressed
+ * with a zstd stream. */
+#define ZSTD_STREAM_CAPABILITY "zstd-stream"
+
 extern const char *const our_capability;
 
 void init_our_capability();
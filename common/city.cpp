@@ -1195,7 +1195,7 @@ bool city_has_building(const struct city *pcity,
   if (nullptr == pimprove) {
     return false;
   }
-  return (pcity->built[improvement_index(pimprove)].turn > I_NEVER);
+  return (city_improvement_built_turn(pcity, pimprove) > I_NEVER);
 }
 
 /**
@@ -3278,6 +3278,7 @@ void city_add_improvement(struct city *pcity,
     // Client just read the info from the packets.
     wonder_built(pcity, pimprove);
   }
+  effect_cache_invalidate();
 }
 
 /**
@@ -3294,6 +3295,7 @@ void city_improvement_built_turn_override(struct city *pcity,
             pcity->built[improvement_index(pimprove)].turn, pcity->name,
             turn);
   pcity->built[improvement_index(pimprove)].turn = turn;
+  effect_cache_invalidate();
 }
 
 /**
@@ -3311,6 +3313,7 @@ void city_remove_improvement(struct city *pcity,
     // Client just read the info from the packets.
     wonder_destroyed(pcity, pimprove);
   }
+  effect_cache_invalidate();
 }
 
 /**
@@ -3327,6 +3330,7 @@ void city_improvement_unmake(struct city *pcity,
     // Client just read the info from the packets.
     wonder_unmade(pcity, pimprove);
   }
+  effect_cache_invalidate();
 }
 
 /**
@@ -3336,9 +3340,52 @@ void city_improvement_unmake(struct city *pcity,
 int city_improvement_built_turn(const struct city *pcity,
                                 const struct impr_type *pimprove)
 {
+  const struct city_overlay *overlay = city_overlay_get();
+
+  if (overlay != nullptr && overlay->pcity == pcity
+      && overlay->pimprove == pimprove) {
+    // As set by city_add_improvement().
+    return game.info.turn;
+  }
   return pcity->built[improvement_index(pimprove)].turn;
 }
 
+static thread_local struct city_overlay current_overlay = {nullptr,
+                                                           nullptr};
+
+/**
+ * Makes the improvement count as built in the city for the calling thread,
+ * until city_overlay_clear() is called. The city and the rest of the game
+ * are left untouched: only the functions querying buildings and wonders
+ * see it. Wonders count as built by the owner of the city.
+ */
+void city_overlay_set(struct city *pcity, const struct impr_type *pimprove)
+{
+  fc_assert_ret(pcity != nullptr);
+  fc_assert_ret(pimprove != nullptr);
+
+  current_overlay.pcity = pcity;
+  current_overlay.pimprove = pimprove;
+}
+
+/**
+ * Removes the overlay set by city_overlay_set().
+ */
+void city_overlay_clear()
+{
+  current_overlay.pcity = nullptr;
+  current_overlay.pimprove = nullptr;
+}
+
+/**
+ * Returns the overlay of the calling thread, or nullptr if there is none.
+ */
+const struct city_overlay *city_overlay_get()
+{
+  return (current_overlay.pimprove != nullptr ? &current_overlay
+                                               : nullptr);
+}
+
 /**
   Returns TRUE iff the city has set the given option.
  */
@@ -3463,6 +3510,9 @@ void destroy_city_virtual(struct city *pcity)
 {
   CALL_FUNC_EACH_AI(city_free, pcity);
 
+  // The address may be reused for another city.
+  effect_cache_invalidate();
+
   citizens_free(pcity);
 
   while (worker_task_list_size(pcity->task_reqs) > 0) {
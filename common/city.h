@@ -687,6 +687,17 @@ void city_improvement_unmake(struct city *pcity,
 int city_improvement_built_turn(const struct city *pcity,
                                 const struct impr_type *pimprove);
 
+/* An improvement considered as built in a city without changing the game
+ * state, to evaluate what it would bring. The overlay is per thread. */
+struct city_overlay {
+  struct city *pcity;
+  const struct impr_type *pimprove;
+};
+
+void city_overlay_set(struct city *pcity, const struct impr_type *pimprove);
+void city_overlay_clear();
+const struct city_overlay *city_overlay_get();
+
 // city update functions
 void city_refresh_from_main_map(
     struct city *pcity, bool *workers_map,
@@ -17,6 +17,7 @@
 // common
 #include "city.h"
 #include "fc_types.h"
+#include "game.h"
 #include "government.h"
 #include "improvement.h"
 #include "multipliers.h"
@@ -29,6 +30,7 @@
 
 // Qt
 #include <QByteArrayAlgorithms> // qstrlen, qstrdup, qstrncpy
+#include <QHash>
 #include <QString>
 #include <QStringLiteral>
 #include <QtContainerFwd> // QVector<QString>
@@ -36,6 +38,7 @@
 // std
 #include <cmath>   // std:pow
 #include <cstring> // str*, mem*
+#include <tuple>   // std::tie
 
 static bool initialized = false;
 
@@ -119,6 +122,93 @@ static struct {
   } reqs;
 } ruleset_cache;
 
+/**
+  Evaluation cache. get_target_bonus() is called with the very same
+  arguments over and over again by city refresh, CM and the AI, and each
+  call walks the effect list of the type and checks all requirements. On
+  the server, the result of such calls is remembered here.
+
+  Only effect types whose requirements all depend on tracked game state are
+  cached (see effect_req_cacheable()). The whole cache is dropped by
+  effect_cache_invalidate(), which is called whenever that state changes:
+  buildings built or lost, techs learned or lost, tile terrain or extras
+  changed, the turn advanced, and objects used as keys destroyed. Tile
+  ownership is not tracked: requirements depending on it aren't cached.
+  Government changes are handled by including the government of the target
+  player in the key, since the AI switches it temporarily for evaluation.
+  The city overlay of the calling thread is part of the key as well.
+
+  Invalidation is O(1): it bumps a generation counter and the entries are
+  freed lazily on the next lookup.
+
+  While the game state is frozen for parallel AI planning, the cache is
+  only read; see effect_cache_freeze().
+ */
+namespace {
+enum class effect_cacheability { unknown, yes, no };
+
+struct effect_cache_context {
+  const struct action *action;
+  const struct impr_type *building;
+  const struct city *city;
+  const struct output_type *output;
+  const struct player *player;
+  const struct specialist *specialist;
+  const struct tile *tile;
+  const struct unit *unit;
+  const struct unit_type *utype;
+  int nintel;
+  int vision_layer;
+};
+
+struct effect_cache_key {
+  int type;
+  const struct government *government;
+  struct city_overlay overlay;
+  struct effect_cache_context target;
+  struct effect_cache_context other;
+};
+
+inline auto effect_cache_tie(const effect_cache_context &ctx)
+{
+  return std::tie(ctx.action, ctx.building, ctx.city, ctx.output,
+                  ctx.player, ctx.specialist, ctx.tile, ctx.unit, ctx.utype,
+                  ctx.nintel, ctx.vision_layer);
+}
+
+inline bool operator==(const effect_cache_key &key1,
+                       const effect_cache_key &key2)
+{
+  return key1.type == key2.type && key1.government == key2.government
+         && key1.overlay.pcity == key2.overlay.pcity
+         && key1.overlay.pimprove == key2.overlay.pimprove
+         && effect_cache_tie(key1.target) == effect_cache_tie(key2.target)
+         && effect_cache_tie(key1.other) == effect_cache_tie(key2.other);
+}
+
+inline size_t qHash(const effect_cache_context &ctx, size_t seed)
+{
+  return qHashMulti(seed, ctx.action, ctx.building, ctx.city, ctx.output,
+                    ctx.player, ctx.specialist, ctx.tile, ctx.unit,
+                    ctx.utype, ctx.nintel, ctx.vision_layer);
+}
+
+inline size_t qHash(const effect_cache_key &key, size_t seed)
+{
+  return qHashMulti(seed, key.type, key.government, key.overlay.pcity,
+                    key.overlay.pimprove, key.target, key.other);
+}
+} // namespace
+
+static struct {
+  effect_cacheability cacheable[EFT_COUNT];
+  QHash<effect_cache_key, int> values;
+  unsigned int generation;
+  unsigned int values_generation;
+  bool frozen;
+  struct effect_cache_stats stats;
+} effect_cache;
+
 /**
    Get a list of all effects.
  */
@@ -184,6 +274,8 @@ struct effect *effect_new(enum effect_type type, int value,
   // Now add the effect to the ruleset cache.
   effect_list_append(ruleset_cache.tracker, peffect);
   effect_list_append(get_effects(type), peffect);
+  effect_cache.cacheable[type] = effect_cacheability::unknown;
+  effect_cache_invalidate();
 
   return peffect;
 }
@@ -213,6 +305,9 @@ void effect_req_append(struct effect *peffect, struct requirement req)
   struct effect_list *eff_list = get_req_source_effects(&req.source);
 
   requirement_vector_append(&peffect->reqs, req);
+  peffect->plan.compiled = false;
+  effect_cache.cacheable[peffect->type] = effect_cacheability::unknown;
+  effect_cache_invalidate();
 
   if (eff_list) {
     effect_list_append(eff_list, peffect);
@@ -244,6 +339,25 @@ void ruleset_cache_init()
   for (i = 0; i < ARRAY_SIZE(ruleset_cache.reqs.advances); i++) {
     ruleset_cache.reqs.advances[i] = effect_list_new();
   }
+
+  for (auto &cacheable : effect_cache.cacheable) {
+    cacheable = effect_cacheability::unknown;
+  }
+  effect_cache_invalidate();
+}
+
+/**
+   Prepares the requirements of all effects for fast evaluation. This should
+   be called once the ruleset is completely loaded. Effects changed later
+   are evaluated from their requirement vector until compiled again.
+ */
+void ruleset_cache_compile()
+{
+  effect_list_iterate(ruleset_cache.tracker, peffect)
+  {
+    req_plan_compile(&peffect->plan, &peffect->reqs);
+  }
+  effect_list_iterate_end;
 }
 
 /**
@@ -302,6 +416,9 @@ void ruleset_cache_free()
     }
   }
 
+  effect_cache.values.clear();
+  effect_cache_invalidate();
+
   initialized = false;
 }
 
@@ -637,6 +754,169 @@ bool is_building_replaced(const struct city *pcity,
                                   effect_type);
 }
 
+/**
+ * Returns TRUE iff the evaluation of the requirement only depends on the
+ * context and on game state whose changes call effect_cache_invalidate().
+ */
+static bool effect_req_cacheable(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_NONE:
+  case VUT_ACTION:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_TOPO:
+  case VUT_VISIONLAYER:
+  case VUT_NINTEL:
+  case VUT_MINYEAR:
+  case VUT_MINCALFRAG:
+  case VUT_AGE:
+    return true;
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+    // Alliances change with diplomacy.
+    return req->range != REQ_RANGE_ALLIANCE;
+  case VUT_GOVERNMENT:
+    return req->range == REQ_RANGE_PLAYER;
+  case VUT_IMPROVEMENT:
+  case VUT_IMPR_GENUS:
+    // Trade routes are not tracked.
+    return (req->range != REQ_RANGE_ALLIANCE
+            && req->range != REQ_RANGE_TRADEROUTE);
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_EXTRA:
+  case VUT_EXTRAFLAG:
+  case VUT_ROADFLAG:
+  case VUT_BASEFLAG:
+    // The tiles of a city change with its radius.
+    return (req->range == REQ_RANGE_LOCAL
+            || req->range == REQ_RANGE_CADJACENT
+            || req->range == REQ_RANGE_ADJACENT);
+  default:
+    return false;
+  }
+}
+
+/**
+ * Returns TRUE iff get_target_bonus() results for this effect type can be
+ * kept in the evaluation cache.
+ */
+static bool effect_type_cacheable(enum effect_type effect_type)
+{
+  effect_cacheability &cacheable = effect_cache.cacheable[effect_type];
+
+  if (cacheable != effect_cacheability::unknown) {
+    return cacheable == effect_cacheability::yes;
+  }
+
+  cacheable = effect_cacheability::yes;
+  effect_list_iterate(get_effects(effect_type), peffect)
+  {
+    // Multipliers are changed by the players at any time.
+    if (peffect->multiplier) {
+      cacheable = effect_cacheability::no;
+      break;
+    }
+    requirement_vector_iterate(&peffect->reqs, preq)
+    {
+      if (!effect_req_cacheable(preq)) {
+        cacheable = effect_cacheability::no;
+        break;
+      }
+    }
+    requirement_vector_iterate_end;
+    if (cacheable == effect_cacheability::no) {
+      break;
+    }
+  }
+  effect_list_iterate_end;
+
+  return cacheable == effect_cacheability::yes;
+}
+
+/**
+ * Fills an evaluation cache context from a requirement context, which may
+ * be nullptr. The player, city, tile and unit type are the ones the
+ * requirements are evaluated against, derived from the unit or city when
+ * the context doesn't give them, so moved, upgraded or captured units and
+ * cities get new keys.
+ */
+static void effect_cache_context_fill(struct effect_cache_context *ctx,
+                                      const struct req_context *context)
+{
+  const struct player *pplayer;
+  const struct city *pcity;
+  const struct tile *ptile;
+  const struct unit_type *putype;
+
+  if (context == nullptr) {
+    *ctx = {nullptr, nullptr, nullptr, nullptr,  nullptr, nullptr,
+            nullptr, nullptr, nullptr, NI_COUNT, V_COUNT};
+    return;
+  }
+
+  req_context_targets(context, &pplayer, &pcity, &ptile, &putype);
+  *ctx = {context->action, context->building, pcity,
+          context->output, pplayer,           context->specialist,
+          ptile,           context->unit,     putype,
+          context->nintel, context->vision_layer};
+}
+
+/**
+ * Drops all values from the evaluation cache. Must be called whenever game
+ * state that requirements depend on changes; see effect_req_cacheable().
+ */
+void effect_cache_invalidate()
+{
+  // The game state must not change while frozen.
+  fc_assert_ret(!effect_cache.frozen);
+
+  effect_cache.generation++;
+  effect_cache.stats.invalidations++;
+}
+
+/**
+ * Freezes or thaws the evaluation cache. A frozen cache is never written
+ * to, so get_target_bonus() can be called from several threads at once.
+ * The game state must not change while the cache is frozen.
+ */
+void effect_cache_freeze(bool frozen)
+{
+  if (frozen) {
+    // Settle everything that is otherwise done lazily.
+    for (int i = 0; i < EFT_COUNT; i++) {
+      (void) effect_type_cacheable(static_cast<enum effect_type>(i));
+    }
+    if (effect_cache.values_generation != effect_cache.generation) {
+      effect_cache.values.clear();
+      effect_cache.values_generation = effect_cache.generation;
+    }
+  }
+  effect_cache.frozen = frozen;
+}
+
+/**
+ * Returns the evaluation cache counters.
+ */
+const struct effect_cache_stats *effect_cache_stats_get()
+{
+  return &effect_cache.stats;
+}
+
+/**
+ * Resets the evaluation cache counters.
+ */
+void effect_cache_stats_reset() { effect_cache.stats = {}; }
+
 /**
  * Returns the effect bonus of a given type for any target.
  */
@@ -663,13 +943,50 @@ int get_target_bonus_effects(struct effect_list *plist,
                              enum effect_type effect_type)
 {
   int bonus = 0;
+  bool cached = false;
+  struct effect_cache_key key;
+
+  // Results with a list of sources are not cached.
+  if (plist == nullptr && is_server() && effect_type_cacheable(effect_type)) {
+    if (!effect_cache.frozen
+        && effect_cache.values_generation != effect_cache.generation) {
+      effect_cache.values.clear();
+      effect_cache.values_generation = effect_cache.generation;
+    }
+
+    key.type = effect_type;
+    if (const struct city_overlay *overlay = city_overlay_get()) {
+      key.overlay = *overlay;
+    } else {
+      key.overlay = {nullptr, nullptr};
+    }
+    effect_cache_context_fill(&key.target, target_context);
+    effect_cache_context_fill(&key.other, other_context);
+    key.government =
+        (key.target.player ? key.target.player->government : nullptr);
+
+    auto it = effect_cache.values.constFind(key);
+    if (it != effect_cache.values.constEnd()) {
+      if (!effect_cache.frozen) {
+        effect_cache.stats.hits++;
+      }
+      return *it;
+    }
+    if (!effect_cache.frozen) {
+      effect_cache.stats.misses++;
+      cached = true;
+    }
+  }
 
   // Loop over all effects of this type.
   effect_list_iterate(get_effects(effect_type), peffect)
   {
     // For each effect, see if it is active.
-    if (are_reqs_active(target_context, other_context, &peffect->reqs,
-                        RPT_CERTAIN)) {
+    if (peffect->plan.compiled
+            ? are_reqs_active(target_context, other_context, &peffect->plan,
+                              RPT_CERTAIN)
+            : are_reqs_active(target_context, other_context, &peffect->reqs,
+                              RPT_CERTAIN)) {
       /* This code will add value of effect. If there's multiplier for
        * effect and target_player aren't null, then value is multiplied
        * by player's multiplier factor. */
@@ -691,6 +1008,10 @@ int get_target_bonus_effects(struct effect_list *plist,
   }
   effect_list_iterate_end;
 
+  if (cached) {
+    effect_cache.values.insert(key, bonus);
+  }
+
   return bonus;
 }
 
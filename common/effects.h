@@ -31,6 +31,9 @@ struct effect {
   /* An effect can have multiple requirements.  The effect will only be
    * active if all of these requirement are met. */
   struct requirement_vector reqs;
+
+  // The requirements prepared for evaluation; see ruleset_cache_compile().
+  struct requirement_plan plan;
 };
 
 // An effect_list is a list of effects.
@@ -54,6 +57,7 @@ QString effect_type_unit_text(effect_type type, int value);
 struct packet_ruleset_effect;
 
 void ruleset_cache_init();
+void ruleset_cache_compile();
 void ruleset_cache_free();
 void recv_ruleset_effect(const struct packet_ruleset_effect *packet);
 void send_ruleset_cache(struct conn_list *dest);
@@ -146,6 +150,18 @@ int get_potential_improvement_bonus(const struct impr_type *pimprove,
                                     enum effect_type effect_type,
                                     const enum req_problem_type prob_type);
 
+// Counters of the get_target_bonus() evaluation cache.
+struct effect_cache_stats {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long invalidations;
+};
+
+void effect_cache_invalidate();
+void effect_cache_freeze(bool frozen);
+const struct effect_cache_stats *effect_cache_stats_get();
+void effect_cache_stats_reset();
+
 const effect_list *get_effects();
 struct effect_list *get_effects(enum effect_type effect_type);
 
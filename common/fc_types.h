@@ -62,6 +62,7 @@
 #define MAX_LEN_ROUTE 2000 // MAX_LEN_PACKET / 2 - header
 #define MAX_LEN_CAPSTR 512
 #define MAX_LEN_PASSWORD 512 // DO NOT change this under any circumstances
+#define MAX_LEN_SESSION_TOKEN 33 // 32 hexadecimal digits
 #define MAX_LEN_VET_SHORT_NAME 8
 #define MAX_LEN_NAME 48
 #define MAX_LEN_CITYNAME 80
@@ -168,6 +168,7 @@ struct civ_game {
       int num_phases;
       int occupychance;
       int onsetbarbarian;
+      bool parallel_ai;
       int pingtime;
       int pingtimeout;
       int ransom_gold;
@@ -176,6 +177,7 @@ struct civ_game {
       int revolution_length;
       int spaceship_travel_time;
       bool threaded_save;
+      bool save_binary_map;
       enum compress_type save_compress_type;
       int save_nturns;
       int save_frequency;
@@ -653,6 +655,10 @@ extern struct world wld;
 
 #define GAME_DEFAULT_THREADED_SAVE false
 
+#define GAME_DEFAULT_SAVE_BINARY_MAP false
+
+#define GAME_DEFAULT_PARALLEL_AI false
+
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
 #define GAME_DEFAULT_SKILL_LEVEL AI_LEVEL_EASY
@@ -711,9 +711,7 @@ def get_lsend(self):
             void lsend_{self.name}(conn_list *dest, const {self.name} *packet,
                                   bool force_to_send)
             {{
-              conn_list_iterate(dest, pconn) {{
-                send_{self.name}(pconn, packet, force_to_send);
-              }} conn_list_iterate_end;
+              lsend_packet(dest, {self.type}, packet, force_to_send);
             }}
 
             """
@@ -915,8 +913,8 @@ def get_send_member(self):
 
         code = dedent(
             f"""\
-            virtual int send(connection *pc, const void *packet_data,
-                             bool force_to_send) override
+            virtual bool encode(connection *pc, const void *packet_data,
+                                bool force_to_send, QByteArray &dout) override
             {{
               [[maybe_unused]]
               auto packet = static_cast<const {self.name} *>(packet_data);
@@ -924,23 +922,95 @@ def get_send_member(self):
         )
         code += real_packet1
         code += delta_header
-        code += "  QByteArray dout;\n"
         code += "  [[maybe_unused]] auto capability = pc->functional_caps;\n"
         code += log
         code += report
         code += body
-
-        # Cancel some is-info packets.
-        for i in self.cancel:
-            field = self.key_field or self.other_fields[0]
-            code += f"\n  pc->phs.handlers[{i}]->reset(real_packet->{field.name});\n"
-
         code += dedent(
             f"""\
+              return true;
+            }}
+
+            virtual int send(connection *pc, const void *packet_data,
+                             bool force_to_send) override
+            {{
+              QByteArray dout;
+              if (!encode(pc, packet_data, force_to_send, dout)) {{
+                return 0;
+              }}
+              sent(pc, packet_data, packet_delta_next_serial());
               return send_packet(pc, {self.type}, dout);
             }}
             """
         )
+        code += self.get_sent_member()
+        return code
+
+    def get_sent_member(self):
+        """
+        Returns a code fragment which implements the members used by
+        lsend_packet() to share the serialized packet between connections
+        with the same delta state.
+        """
+
+        code = ""
+        if self.delta and self.key_field is None:
+            code += dedent(
+                f"""
+                virtual unsigned sent_serial(const void *packet_data) const override
+                {{
+                  Q_UNUSED(packet_data);
+                  return last_sent_serial;
+                }}
+
+                virtual void adopt(const void *packet_data) override
+                {{
+                  last_sent = *static_cast<const {self.name} *>(packet_data);
+                }}
+                """
+            )
+            set_serial = "  last_sent_serial = serial;\n"
+        elif self.delta:
+            key = f"static_cast<const {self.name} *>(packet_data)->{self.key_field.name}"
+            code += dedent(
+                f"""
+                virtual unsigned sent_serial(const void *packet_data) const override
+                {{
+                  auto it = sent_serials.find({key});
+                  return it == sent_serials.end() ? 0 : it->second;
+                }}
+
+                virtual void adopt(const void *packet_data) override
+                {{
+                  auto real_packet = static_cast<const {self.name} *>(packet_data);
+                  send_map.insert_or_assign(real_packet->{self.key_field.name}, *real_packet);
+                }}
+                """
+            )
+            set_serial = f"  sent_serials[{key}] = serial;\n"
+        else:
+            set_serial = "  Q_UNUSED(serial);\n"
+
+        if not self.delta and not self.cancel:
+            return code
+
+        code += dedent(
+            f"""
+            virtual void sent(connection *pc, const void *packet_data,
+                              unsigned serial) override
+            {{
+            """
+        )
+        if not self.cancel:
+            code += "  Q_UNUSED(pc);\n"
+        code += set_serial
+
+        # Cancel some is-info packets.
+        for i in self.cancel:
+            field = self.key_field or self.other_fields[0]
+            code += f"  pc->phs.handlers[{i}]->reset(static_cast<const {self.name} *>(packet_data)->{field.name});\n"
+
+        code += "}\n"
         return code
 
     def get_delta_send_body(self):
@@ -1001,7 +1071,7 @@ def get_delta_send_body(self):
         if self.is_info != "no":
             body += f"""
   if (different == 0) {{
-{fl}{s}    return 0;
+{fl}{s}    return false;
   }}
 """
 
@@ -843,18 +843,43 @@ bool wonder_is_lost(const struct player *pplayer,
   return pplayer->wonders[improvement_index(pimprove)] == WONDER_LOST;
 }
 
+/**
+   Returns the city in which the city overlay of the calling thread builds
+   this wonder, or nullptr.
+ */
+static struct city *overlay_wonder_city(const struct impr_type *pimprove)
+{
+  const struct city_overlay *overlay = city_overlay_get();
+
+  return (overlay != nullptr && overlay->pimprove == pimprove
+              ? overlay->pcity
+              : nullptr);
+}
+
 /**
    Returns whether the player is currently in possession of this wonder
    (small or great)  and it hasn't been just built this turn.
+
+   A wonder added by the city overlay counts as built at once: the overlay
+   evaluates what the wonder brings once it takes effect.
  */
 bool wonder_is_built(const struct player *pplayer,
                      const struct impr_type *pimprove)
 {
   int windex = improvement_index(pimprove);
+  const struct city *overlay_city = overlay_wonder_city(pimprove);
 
   fc_assert_ret_val(nullptr != pplayer, false);
   fc_assert_ret_val(is_wonder(pimprove), false);
 
+  if (overlay_city != nullptr && city_owner(overlay_city) == pplayer) {
+    /* Like a wonder added by city_add_improvement(): wonder_built() sets
+     * no build turn (-1), so the check below would not hold it back
+     * either. Holding it back would leave the AI with no want for the
+     * effects of any wonder. */
+    return true;
+  }
+
   /* New city turn: Wonders don't take effect until the next
    * turn after building */
 
@@ -875,10 +900,15 @@ struct city *city_from_wonder(const struct player *pplayer,
                               const struct impr_type *pimprove)
 {
   int city_id = pplayer->wonders[improvement_index(pimprove)];
+  struct city *overlay_city = overlay_wonder_city(pimprove);
 
   fc_assert_ret_val(nullptr != pplayer, nullptr);
   fc_assert_ret_val(is_wonder(pimprove), nullptr);
 
+  if (overlay_city != nullptr && city_owner(overlay_city) == pplayer) {
+    return overlay_city;
+  }
+
   if (!WONDER_BUILT(city_id)) {
     return nullptr;
   }
@@ -920,6 +950,10 @@ bool great_wonder_is_built(const struct impr_type *pimprove)
   int owner;
   fc_assert_ret_val(is_great_wonder(pimprove), false);
 
+  if (overlay_wonder_city(pimprove) != nullptr) {
+    return true;
+  }
+
   owner = game.info.great_wonder_owners[windex];
   /* call wonder_is_built() to check the build turn */
   return (WONDER_OWNED(owner)
@@ -944,6 +978,10 @@ bool great_wonder_is_available(const struct impr_type *pimprove)
 {
   fc_assert_ret_val(is_great_wonder(pimprove), false);
 
+  if (overlay_wonder_city(pimprove) != nullptr) {
+    return false;
+  }
+
   return (WONDER_NOT_OWNED
           == game.info.great_wonder_owners[improvement_index(pimprove)]);
 }
@@ -955,9 +993,14 @@ bool great_wonder_is_available(const struct impr_type *pimprove)
 struct city *city_from_great_wonder(const struct impr_type *pimprove)
 {
   int player_id = game.info.great_wonder_owners[improvement_index(pimprove)];
+  struct city *overlay_city = overlay_wonder_city(pimprove);
 
   fc_assert_ret_val(is_great_wonder(pimprove), nullptr);
 
+  if (overlay_city != nullptr) {
+    return overlay_city;
+  }
+
   if (WONDER_OWNED(player_id)) {
 #ifdef FREECIV_DEBUG
     const struct player *pplayer = player_by_number(player_id);
@@ -987,9 +1030,14 @@ struct city *city_from_great_wonder(const struct impr_type *pimprove)
 struct player *great_wonder_owner(const struct impr_type *pimprove)
 {
   int player_id = game.info.great_wonder_owners[improvement_index(pimprove)];
+  struct city *overlay_city = overlay_wonder_city(pimprove);
 
   fc_assert_ret_val(is_great_wonder(pimprove), nullptr);
 
+  if (overlay_city != nullptr) {
+    return city_owner(overlay_city);
+  }
+
   if (WONDER_OWNED(player_id)) {
     return player_by_number(player_id);
   } else {
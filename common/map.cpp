@@ -13,6 +13,7 @@
 // common
 #include "ai.h"
 #include "city.h"
+#include "effects.h"
 #include "extras.h"
 #include "fc_types.h"
 #include "game.h"
@@ -135,6 +136,7 @@ void map_init(struct civ_map *imap, bool server_side)
   imap->num_continents = 0;
   imap->num_oceans = 0;
   imap->tiles = nullptr;
+  imap->hot = nullptr;
   imap->startpos_table = nullptr;
   imap->iterate_outwards_indices = nullptr;
 
@@ -329,7 +331,7 @@ static void tile_init(struct tile *ptile)
   BV_CLR_ALL(ptile->extras);
   ptile->resource = nullptr;
   ptile->terrain = T_UNKNOWN;
-  ptile->units = unit_list_new();
+  ptile->units = unit_list_new_pooled();
   ptile->owner = nullptr; // Not claimed by any player.
   ptile->extras_owner = nullptr;
   ptile->placing = nullptr;
@@ -480,10 +482,43 @@ void map_allocate(struct civ_map *amap)
     tile_init(ptile);
   }
   whole_map_iterate_end;
+
+  fc_assert(nullptr == amap->hot);
+  amap->hot = new tile_hot_fields;
+  map_hot_fields_sync(amap);
+
   delete amap->startpos_table;
   amap->startpos_table = new QHash<struct tile *, struct startpos *>;
 }
 
+/**
+   Rebuild the hot tile field arrays from the tiles of the map.  Needed
+   after the tiles have been written directly, e.g. by savegame loaders.
+ */
+void map_hot_fields_sync(struct civ_map *nmap)
+{
+  struct tile_hot_fields *hot = nmap->hot;
+  const int size = nmap->xsize * nmap->ysize;
+
+  fc_assert_ret(nullptr != hot);
+
+  hot->terrain.resize(size);
+  hot->continent.resize(size);
+  hot->owner.resize(size);
+  hot->extras.resize(size);
+
+  for (int i = 0; i < size; i++) {
+    const struct tile *ptile = nmap->tiles + i;
+
+    hot->terrain[i] =
+        ptile->terrain != T_UNKNOWN ? terrain_number(ptile->terrain) : -1;
+    hot->continent[i] = ptile->continent;
+    hot->owner[i] =
+        ptile->owner != nullptr ? player_number(ptile->owner) : -1;
+    hot->extras[i] = ptile->extras;
+  }
+}
+
 /**
    Allocate main map and related global structures.
  */
@@ -509,6 +544,9 @@ void map_free(struct civ_map *fmap)
     delete[] fmap->tiles;
     fmap->tiles = nullptr;
 
+    delete fmap->hot;
+    fmap->hot = nullptr;
+
     if (fmap->startpos_table) {
       for (auto *a : std::as_const(*fmap->startpos_table)) {
         startpos_destroy(a);
@@ -519,6 +557,8 @@ void map_free(struct civ_map *fmap)
 
     delete[] fmap->iterate_outwards_indices;
     fmap->iterate_outwards_indices = nullptr;
+
+    effect_cache_invalidate();
   }
 }
 
@@ -41,6 +41,7 @@ void map_init_topology();
 void map_allocate(struct civ_map *amap);
 void main_map_allocate();
 void map_free(struct civ_map *fmap);
+void map_hot_fields_sync(struct civ_map *nmap);
 void main_map_free();
 
 int map_vector_to_real_distance(int dx, int dy);
@@ -479,6 +480,37 @@ extern struct terrain_misc terrain_control;
   }                                                                         \
   }
 
+/* Iterate over the index of all positions on the globe, for passes that
+ * only read the hot tile fields (see struct tile_hot_fields). */
+#define whole_map_index_iterate(_map, _index)                               \
+  {                                                                         \
+    const int _index##_size = (_map)->xsize * (_map)->ysize;                \
+    for (int _index = 0; _index < _index##_size; _index++) {
+
+#define whole_map_index_iterate_end                                         \
+  }                                                                         \
+  }
+
+// Hot tile field accessors, by tile index.
+static inline struct terrain *map_hot_terrain(const struct civ_map *nmap,
+                                              int index)
+{
+  const int id = nmap->hot->terrain[index];
+
+  return id >= 0 ? terrain_by_number(id) : T_UNKNOWN;
+}
+
+static inline struct player *map_hot_owner(const struct civ_map *nmap,
+                                           int index)
+{
+  const int id = nmap->hot->owner[index];
+
+  return id >= 0 ? player_by_number(id) : nullptr;
+}
+
+#define map_hot_continent(_map, _index) ((_map)->hot->continent[_index])
+#define map_hot_extras(_map, _index) (&(_map)->hot->extras[_index])
+
 BV_DEFINE(dir_vector, 8);
 
 // return the reverse of the direction
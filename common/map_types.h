@@ -10,6 +10,9 @@
 #include <QHash>
 #include <QSet>
 
+// std
+#include <vector>
+
 /****************************************************************
   Miscellaneous terrain information
 *****************************************************************/
@@ -57,6 +60,19 @@ enum map_startpos {
 #define SPECENUM_VALUE4 TEAM_PLACEMENT_VERTICAL
 #include "specenum_gen.h"
 
+/* Copies of the most frequently read tile fields, stored one array per
+ * field and indexed by tile index.  Passes over the whole map that only
+ * need these fields can read them without pulling every struct tile into
+ * the cache.  The arrays are kept up to date by the tile_set_*() and
+ * tile_add/remove_extra() setters; code that writes struct tile directly
+ * must call map_hot_fields_sync() when it is done. */
+struct tile_hot_fields {
+  std::vector<signed char> terrain; // terrain_number(), or -1 if unknown
+  std::vector<Continent_id> continent;
+  std::vector<short> owner; // player_number(), or -1 if not owned
+  std::vector<bv_extras> extras;
+};
+
 struct civ_map {
   int topology_id;
   enum direction8 valid_dirs[8], cardinal_dirs[8];
@@ -67,6 +83,7 @@ struct civ_map {
   int num_continents;
   int num_oceans; // not updated at the client
   struct tile *tiles;
+  struct tile_hot_fields *hot;
   QHash<struct tile *, struct startpos *> *startpos_table;
 
   union {
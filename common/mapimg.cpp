@@ -25,25 +25,28 @@
 // Qt
 #include <QByteArray>
 #include <QByteArrayAlgorithms> // qstrlen, qstrdup, qstrncpy
-#include <QColor>
 #include <QFileInfo>
+#include <QGlobalStatic> // Q_GLOBAL_STATIC
 #include <QImage>
 #include <QImageWriter>
 #include <QLatin1String>
-#include <QPainter>
+#include <QRgb> // qRgb
 #include <QString>
 #include <QStringLiteral>
+#include <QThreadPool>
 #include <Qt>                    // Qt::*
 #include <QtContainerFwd>        // QStringList = QList<QString>
 #include <QtLogging>             // qDebug, qWarning, qCricital, etc
 #include <QtPreprocessorSupport> // Q_UNUSED
 
 // std
-#include <cstdarg> // va_*
-#include <cstddef> // size_t
-#include <cstdio>  // sscanf
-#include <cstring> // str*, mem*
-#include <utility> // std::as_const
+#include <algorithm> // std::fill_n
+#include <cstdarg>   // va_*
+#include <cstddef>   // size_t
+#include <cstdio>    // sscanf
+#include <cstring>   // str*, mem*
+#include <utility>   // std::as_const
+#include <vector>
 
 // == image colors ==
 enum img_special {
@@ -300,7 +303,7 @@ struct img {
 };
 
 static struct img *img_new(struct mapdef *mapdef, int topo, int xsize,
-                           int ysize);
+                           int ysize, const char *title);
 static void img_destroy(struct img *pimg);
 static inline void img_set_pixel(struct img *pimg, const int mindex,
                                  const struct rgbcolor *pcolor);
@@ -312,11 +315,25 @@ static void img_plot_tile(struct img *pimg, const struct tile *ptile,
                           const struct rgbcolor *pcolor,
                           const bv_pixel pixel);
 static bool img_save(const struct img *pimg, const char *mapimgfile,
-                     const char *path);
+                     const char *path, bool background, const char **error);
 static bool img_filename(const char *mapimgfile, const QByteArray &format,
                          char *filename, size_t filename_len);
 static void img_createmap(struct img *pimg);
 
+// One image to be rendered by mapimg_create().
+struct img_job {
+  struct mapdef def;
+  char filename[MAX_LEN_PATH];
+  const char *error; // nullptr if the image was created
+};
+
+static void img_title(char *title, size_t title_len);
+static bool img_create_jobs(std::vector<img_job> &jobs, const char *title,
+                            const char *path, bool background);
+
+// Encodes and writes images in the background, see mapimg_create().
+Q_GLOBAL_STATIC(QThreadPool, img_writers)
+
 // == logging ==
 #define MAX_LEN_ERRORBUF 1024
 
@@ -419,6 +436,9 @@ void mapimg_free()
     return;
   }
 
+  // Let pending images reach the disk.
+  img_writers->waitForDone();
+
   mapimg_reset();
   mapdef_list_destroy(mapimg.mapdef);
 
@@ -1057,13 +1077,18 @@ bool mapimg_id2str(int id, char *str, size_t str_len)
    contains the map definition and <mapext> the selected image extension.
    If 'force' is FALSE, the image is only created if game.info.turn is a
    multiple of the map setting turns.
+
+   When one image per player is requested, the images are rendered in
+   parallel. If 'background' is TRUE, encoding and writing the files is
+   left to background threads; a success return then only means that the
+   images were rendered.
  */
 bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
-                   const char *path)
+                   const char *path, bool background)
 {
-  struct img *pimg;
-  char mapimgfile[MAX_LEN_PATH];
-  bool ret = true;
+  std::vector<img_job> jobs;
+  char title[MAX_LEN_MAPDEF];
+  bool ret;
 #ifdef FREECIV_DEBUG
   civtimer *timer_cpu, *timer_user;
 #endif
@@ -1098,6 +1123,13 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
   timer_start(timer_user);
 #endif // FREECIV_DEBUG
 
+  /* The previous batch of images may still be written; wait for it so
+   * they don't pile up in memory. */
+  img_writers->waitForDone();
+
+  // The title and file names use static buffers: build them here.
+  img_title(title, sizeof(title));
+
   // create map
   switch (pmapdef->player.show) {
   case SHOW_PLRNAME: // display player given by name
@@ -1105,15 +1137,10 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
   case SHOW_NONE:    // no player one the map
   case SHOW_ALL:     // show all players in one map
   case SHOW_PLRBV:   // display player(s) given by bitvector
-    generate_save_name(savename, mapimgfile, sizeof(mapimgfile),
+    jobs.push_back({*pmapdef, "", nullptr});
+    generate_save_name(savename, jobs.back().filename,
+                       sizeof(jobs.back().filename),
                        mapimg_generate_name(pmapdef));
-
-    pimg = img_new(pmapdef, CURRENT_TOPOLOGY, wld.map.xsize, wld.map.ysize);
-    img_createmap(pimg);
-    if (!img_save(pimg, mapimgfile, path)) {
-      ret = false;
-    }
-    img_destroy(pimg);
     break;
   case SHOW_EACH:  // one map for each player
   case SHOW_HUMAN: // one map for each human player
@@ -1129,25 +1156,17 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
       BV_CLR_ALL(pmapdef->player.checked_plrbv);
       BV_SET(pmapdef->player.checked_plrbv, player_index(pplayer));
 
-      generate_save_name(savename, mapimgfile, sizeof(mapimgfile),
+      jobs.push_back({*pmapdef, "", nullptr});
+      generate_save_name(savename, jobs.back().filename,
+                         sizeof(jobs.back().filename),
                          mapimg_generate_name(pmapdef));
-
-      pimg =
-          img_new(pmapdef, CURRENT_TOPOLOGY, wld.map.xsize, wld.map.ysize);
-      img_createmap(pimg);
-      if (!img_save(pimg, mapimgfile, path)) {
-        ret = false;
-      }
-      img_destroy(pimg);
-
-      if (!ret) {
-        break;
-      }
     }
     players_iterate_end;
     break;
   }
 
+  ret = img_create_jobs(jobs, title, path, background);
+
 #ifdef FREECIV_DEBUG
   log_debug("Image generation time: %g seconds (%g apparent)",
             timer_read_seconds(timer_cpu), timer_read_seconds(timer_user));
@@ -1171,6 +1190,7 @@ bool mapimg_colortest(const char *savename, const char *path)
   const struct rgbcolor *pcolor;
   struct mapdef *pmapdef = mapdef_new(true);
   char mapimgfile[MAX_LEN_PATH];
+  char title[MAX_LEN_MAPDEF];
   bv_pixel pixel;
   int i, nat_x, nat_y;
   int max_playercolor = mapimg.mapimg_plrcolor_count();
@@ -1180,8 +1200,9 @@ bool mapimg_colortest(const char *savename, const char *path)
 #define SIZE_X 16
 #define SIZE_Y 5
 
+  img_title(title, sizeof(title));
   pimg = img_new(pmapdef, 0, SIZE_X + 2,
-                 SIZE_Y * (max_playercolor / SIZE_X) + 2);
+                 SIZE_Y * (max_playercolor / SIZE_X) + 2, title);
 
   pixel = pimg->pixel_tile(nullptr, nullptr, false);
 
@@ -1238,9 +1259,12 @@ bool mapimg_colortest(const char *savename, const char *path)
     // filename for color test
     generate_save_name(savename, mapimgfile, sizeof(mapimgfile), buf);
 
-    if (!img_save(pimg, mapimgfile, path)) {
+    const char *error;
+
+    if (!img_save(pimg, mapimgfile, path, false, &error)) {
       /* If one of the mapimg format/toolkit combination fail, return
        * FALSE, i.e. an error occurred. */
+      MAPIMG_LOG("%s", error);
       ret = false;
     }
   }
@@ -1553,18 +1577,67 @@ static void mapdef_destroy(struct mapdef *pmapdef)
  * ==============================================
  */
 
+/**
+   Write the title of the images for the current turn. Not thread-safe.
+ */
+static void img_title(char *title, size_t title_len)
+{
+  fc_snprintf(title, title_len, _("Turn: %4d - Year: %10s"), game.info.turn,
+              calendar_text());
+}
+
+/**
+   Render and save the images described by 'jobs'. Several images are
+   rendered at once, each by its own thread; since an image only lives
+   while its thread works on it, memory use is bounded by the size of the
+   thread pool. The game state is only read, and the errors are kept in
+   the jobs until the threads are done: MAPIMG_LOG() is not thread-safe.
+   Returns FALSE if any image failed.
+ */
+static bool img_create_jobs(std::vector<img_job> &jobs, const char *title,
+                            const char *path, bool background)
+{
+  auto create = [=](img_job &job) {
+    struct img *pimg = img_new(&job.def, CURRENT_TOPOLOGY, wld.map.xsize,
+                               wld.map.ysize, title);
+    img_createmap(pimg);
+    (void) img_save(pimg, job.filename, path, background, &job.error);
+    img_destroy(pimg);
+  };
+
+  if (jobs.size() == 1) {
+    create(jobs.front());
+  } else {
+    QThreadPool pool;
+    for (auto &job : jobs) {
+      pool.start([&create, &job] { create(job); });
+    }
+    pool.waitForDone();
+  }
+
+  bool ret = true;
+
+  for (const auto &job : jobs) {
+    if (job.error != nullptr) {
+      MAPIMG_LOG("%s", job.error);
+      ret = false;
+    }
+  }
+
+  return ret;
+}
+
 /**
    Create a new image.
  */
 static struct img *img_new(struct mapdef *mapdef, int topo, int xsize,
-                           int ysize)
+                           int ysize, const char *title)
 {
   auto *pimg = new img;
 
   pimg->def = mapdef;
   pimg->turn = game.info.turn;
-  fc_snprintf(pimg->title, sizeof(pimg->title), _("Turn: %4d - Year: %10s"),
-              game.info.turn, calendar_text());
+  fc_strlcpy(pimg->title, title, sizeof(pimg->title));
 
   pimg->mapsize.x = xsize; // x size of the map
   pimg->mapsize.y = ysize; // y size of the map
@@ -1722,13 +1795,18 @@ static void img_plot_tile(struct img *pimg, const struct tile *ptile,
 }
 
 /**
-   Save an image.
+   Save an image. If 'background' is TRUE, the file is encoded and written
+   by img_writers. On failure, 'error' is set to the (translated) message
+   for MAPIMG_LOG(), which the caller must use from the main thread;
+   otherwise it is set to nullptr.
  */
 static bool img_save(const struct img *pimg, const char *mapimgfile,
-                     const char *path)
+                     const char *path, bool background, const char **error)
 {
   char tmpname[600];
 
+  *error = nullptr;
+
   if (!QFileInfo(mapimgfile).isAbsolute() && path != nullptr) {
     make_dir(path);
 
@@ -1746,14 +1824,14 @@ static bool img_save(const struct img *pimg, const char *mapimgfile,
 
   if (!img_filename(mapimgfile, pimg->def->format, pngname,
                     sizeof(pngname))) {
-    MAPIMG_LOG(_("error generating the file name"));
+    *error = _("error generating the file name");
     return false;
   }
 
   QImage image(pimg->imgsize.x * pimg->def->zoom,
                pimg->imgsize.y * pimg->def->zoom, QImage::Format_ARGB32);
   if (image.isNull()) {
-    MAPIMG_LOG(_("could not allocate memory for image"));
+    *error = _("could not allocate memory for image");
     return false;
   }
 
@@ -1783,22 +1861,30 @@ static bool img_save(const struct img *pimg, const char *mapimgfile,
     players_iterate_end;
   }
 
-  image.setDevicePixelRatio(pimg->def->zoom);
+  const int zoom = pimg->def->zoom;
+  image.setDevicePixelRatio(zoom);
   image.fill(Qt::transparent);
 
-  QPainter p;
-  p.begin(&image);
-
-  // Iterate over tiles
+  // Each image pixel becomes a zoom x zoom block, written row by row.
   for (int y = 0; y < pimg->imgsize.y; y++) {
-    for (int x = 0; x < pimg->imgsize.x; x++) {
-      if (const auto pcolor = pimg->map[img_index(x, y, pimg)]; pcolor) {
-        p.fillRect(x, y, 1, 1, QColor(pcolor->r, pcolor->g, pcolor->b));
+    for (int dy = 0; dy < zoom; dy++) {
+      auto line = reinterpret_cast<QRgb *>(image.scanLine(y * zoom + dy));
+      for (int x = 0; x < pimg->imgsize.x; x++) {
+        if (const auto pcolor = pimg->map[img_index(x, y, pimg)]; pcolor) {
+          std::fill_n(line + x * zoom, zoom,
+                      qRgb(pcolor->r, pcolor->g, pcolor->b));
+        }
       }
     }
   }
 
-  p.end();
+  if (background) {
+    img_writers->start([image, name = QString::fromUtf8(pngname)] {
+      image.save(name);
+      qDebug("Map image saved as '%s'.", qUtf8Printable(name));
+    });
+    return true;
+  }
 
   image.save(pngname);
   qDebug("Map image saved as '%s'.", pngname);
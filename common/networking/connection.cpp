@@ -5,6 +5,7 @@
 #include "connection.h"
 
 // generated
+#include <fc_config.h>
 #include <packets_gen.h>
 
 // utility
@@ -16,6 +17,7 @@
 #include "timing.h"
 
 // common
+#include "capstr.h"
 #include "fc_types.h"
 #include "game.h"
 #include "packets.h"
@@ -502,6 +504,9 @@ void connection_common_init(struct connection *pconn)
 
   byte_vector_init(&pconn->compression.queue);
   pconn->compression.frozen_level = 0;
+  pconn->compression.zstd = false;
+  pconn->compression.zstd_out = nullptr;
+  pconn->compression.zstd_in = nullptr;
 }
 
 /**
@@ -530,6 +535,7 @@ void connection_common_close(struct connection *pconn)
     }
 
     byte_vector_free(&pconn->compression.queue);
+    conn_compression_free(pconn);
     free_packet_hashes(pconn);
   }
 }
@@ -552,6 +558,11 @@ void conn_set_capability(struct connection *pconn, const char *capability)
     }
   }
   pconn->phs.handlers = packet_handlers_get(pconn->functional_caps);
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  pconn->compression.zstd =
+      has_capability(ZSTD_STREAM_CAPABILITY, capability);
+#endif
 }
 
 /**
@@ -137,6 +137,12 @@ struct connection {
     int frozen_level;
 
     struct byte_vector queue;
+
+    /// Whether to compress with zstd. Set when the peer supports it.
+    bool zstd;
+    /// zstd stream contexts, created when first used.
+    struct ZSTD_CCtx_s *zstd_out;
+    struct ZSTD_DCtx_s *zstd_in;
   } compression;
   struct {
     int bytes_send;
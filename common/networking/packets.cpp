@@ -5,6 +5,7 @@
 #include "packets.h"
 
 // generated
+#include <fc_config.h>
 #include <packets_gen.h>
 
 // utility
@@ -24,7 +25,6 @@
 #include <QByteArrayAlgorithms> // qstrlen, qstrdup, qstrncpy
 #include <QGlobalStatic>        // Q_GLOBAL_STATIC
 #include <QRegularExpression>
-#include <QScopedArrayPointer>
 #include <QString>
 #include <QtContainerFwd>        // QVector<QString>
 #include <QtLogging>             // qDebug, qWarning, qCricital, etc
@@ -34,9 +34,16 @@
 #include <cstdint> // std::int*, std::uint*
 #include <cstdlib> // EXIT_FAILURE, free, at_quick_exit
 #include <cstring> // str*, mem*
+#include <map>
+#include <optional>
+#include <utility> // std::make_pair
 #include <zconf.h> // uLongf, Bytef
 #include <zlib.h>  // Z_*
 
+#ifdef FREECIV_HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
 /*
  * Value for the 16bit size to indicate a jumbo packet
  */
@@ -57,6 +64,20 @@
 
 #define MAX_DECOMPRESSION 400
 
+/*
+ * First byte of the payload of zstd-compressed packets. zlib streams always
+ * start with a byte whose lower nibble is 8 (deflate), so the receiver can
+ * tell them apart.
+ */
+#define ZSTD_CHUNK_MARKER 0xff
+
+/*
+ * Queues smaller than this are sent uncompressed when using zstd. The
+ * decision must be taken before compressing, because the zstd stream
+ * cannot skip data.
+ */
+#define ZSTD_MIN_SIZE 64
+
 /*
  * Valid values are 0, 1 and 2. For 2 you have to set generate_stats
  * to 1 in generate_packets.py.
@@ -67,6 +88,8 @@ static int stat_size_alone = 0;
 static int stat_size_uncompressed = 0;
 static int stat_size_compressed = 0;
 static int stat_size_no_compression = 0;
+static int stat_size_zstd_uncompressed = 0;
+static int stat_size_zstd_compressed = 0;
 
 /**
    Returns the compression level. Initilialize it if needed.
@@ -86,32 +109,120 @@ static inline int get_compression_level()
   return level;
 }
 
+/**
+   Sends a compressed chunk of data, with the header telling its size.
+ */
+static void conn_send_compressed(struct connection *pconn,
+                                 QByteArrayView compressed)
+{
+  /* Compression signalling currently assumes a 2-byte packet length; if that
+   * changes, the protocol should probably be changed */
+  fc_assert_ret(data_type_size(data_type(pconn->packet_header.length))
+                == 2);
+
+  // Include normal length field in decision
+  bool jumbo = (compressed.size() + 2 >= JUMBO_BORDER);
+  QByteArray dout;
+
+  if (!jumbo) {
+    FC_STATIC_ASSERT(COMPRESSION_BORDER > MAX_LEN_PACKET,
+                     uncompressed_compressed_packet_len_overlap);
+
+    log_compress("COMPRESS: sending %lld as normal", compressed.size());
+    dio_put<std::uint16_t>(dout, 2 + compressed.size() + COMPRESSION_BORDER);
+  } else {
+    FC_STATIC_ASSERT(JUMBO_SIZE >= JUMBO_BORDER + COMPRESSION_BORDER,
+                     compressed_normal_jumbo_packet_len_overlap);
+
+    log_compress("COMPRESS: sending %lld as jumbo", compressed.size());
+    dio_put<std::uint16_t>(dout, JUMBO_SIZE);
+    dio_put<std::uint32_t>(dout, 6 + compressed.size());
+  }
+  connection_send_data(pconn, dout);
+  connection_send_data(pconn, compressed);
+}
+
+#ifdef FREECIV_HAVE_LIBZSTD
+/**
+   Send all waiting data compressed with the zstd stream of the connection.
+   The stream is kept across calls, so later data is compressed using the
+   earlier data as a dictionary. Return TRUE on success.
+ */
+static bool conn_compression_flush_zstd(struct connection *pconn)
+{
+  static QByteArray compressed; // Reused to avoid allocations
+  auto *queue = &pconn->compression.queue;
+
+  if (queue->size < ZSTD_MIN_SIZE) {
+    connection_send_data(pconn, QByteArrayView(queue->p, queue->size));
+    stat_size_no_compression += queue->size;
+    return pconn->used;
+  }
+
+  if (nullptr == pconn->compression.zstd_out) {
+    int level = get_compression_level();
+
+    pconn->compression.zstd_out = ZSTD_createCCtx();
+    fc_assert_ret_val(nullptr != pconn->compression.zstd_out, false);
+    ZSTD_CCtx_setParameter(pconn->compression.zstd_out,
+                           ZSTD_c_compressionLevel,
+                           0 < level ? level : ZSTD_CLEVEL_DEFAULT);
+  }
+
+  compressed.resize(1 + ZSTD_compressBound(queue->size));
+  compressed[0] = char(ZSTD_CHUNK_MARKER);
+
+  ZSTD_inBuffer in = {queue->p, queue->size, 0};
+  ZSTD_outBuffer out = {compressed.data(), size_t(compressed.size()), 1};
+  size_t remaining;
+  do {
+    remaining = ZSTD_compressStream2(pconn->compression.zstd_out, &out, &in,
+                                     ZSTD_e_flush);
+    fc_assert_ret_val_msg(!ZSTD_isError(remaining), false,
+                          "zstd compression failed: %s",
+                          ZSTD_getErrorName(remaining));
+    if (0 != remaining) {
+      compressed.resize(2 * compressed.size());
+      out.dst = compressed.data();
+      out.size = compressed.size();
+    }
+  } while (0 != remaining);
+
+  log_compress("COMPRESS: zstd compressed %lu bytes to %lu",
+               (unsigned long) queue->size, (unsigned long) out.pos);
+  stat_size_zstd_uncompressed += queue->size;
+  stat_size_zstd_compressed += out.pos;
+
+  conn_send_compressed(pconn, QByteArrayView(compressed.data(), out.pos));
+  return pconn->used;
+}
+#endif // FREECIV_HAVE_LIBZSTD
+
 /**
    Send all waiting data. Return TRUE on success.
  */
 static bool conn_compression_flush(struct connection *pconn)
 {
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (pconn->compression.zstd) {
+    return conn_compression_flush_zstd(pconn);
+  }
+#endif
+
+  static QByteArray compressed; // Reused to avoid allocations
   int compression_level = get_compression_level();
   uLongf compressed_size = 12 + 1.001 * pconn->compression.queue.size;
   int error;
-  QScopedArrayPointer<Bytef> compressed(new Bytef[compressed_size]);
-  bool jumbo;
   unsigned long compressed_packet_len;
 
-  error = compress2(compressed.data(), &compressed_size,
-                    pconn->compression.queue.p,
+  compressed.resize(compressed_size);
+  error = compress2(reinterpret_cast<Bytef *>(compressed.data()),
+                    &compressed_size, pconn->compression.queue.p,
                     pconn->compression.queue.size, compression_level);
   fc_assert_ret_val(error == Z_OK, false);
 
-  /* Compression signalling currently assumes a 2-byte packet length; if that
-   * changes, the protocol should probably be changed */
-  fc_assert_ret_val(
-      data_type_size(data_type(pconn->packet_header.length)) == 2, false);
-
-  // Include normal length field in decision
-  jumbo = (compressed_size + 2 >= JUMBO_BORDER);
-
-  compressed_packet_len = compressed_size + (jumbo ? 6 : 2);
+  compressed_packet_len =
+      compressed_size + (compressed_size + 2 >= JUMBO_BORDER ? 6 : 2);
   if (compressed_packet_len < pconn->compression.queue.size) {
     log_compress("COMPRESS: compressed %lu bytes to %ld (level %d)",
                  (unsigned long) pconn->compression.queue.size,
@@ -119,29 +230,8 @@ static bool conn_compression_flush(struct connection *pconn)
     stat_size_uncompressed += pconn->compression.queue.size;
     stat_size_compressed += compressed_size;
 
-    if (!jumbo) {
-      FC_STATIC_ASSERT(COMPRESSION_BORDER > MAX_LEN_PACKET,
-                       uncompressed_compressed_packet_len_overlap);
-
-      log_compress("COMPRESS: sending %ld as normal", compressed_size);
-
-      QByteArray dout;
-      dio_put<std::uint16_t>(dout, 2 + compressed_size + COMPRESSION_BORDER);
-      connection_send_data(pconn, dout);
-      connection_send_data(
-          pconn, QByteArrayView(compressed.data(), compressed_size));
-    } else {
-      FC_STATIC_ASSERT(JUMBO_SIZE >= JUMBO_BORDER + COMPRESSION_BORDER,
-                       compressed_normal_jumbo_packet_len_overlap);
-
-      log_compress("COMPRESS: sending %ld as jumbo", compressed_size);
-      QByteArray dout;
-      dio_put<std::uint16_t>(dout, JUMBO_SIZE);
-      dio_put<std::uint32_t>(dout, 6 + compressed_size);
-      connection_send_data(pconn, dout);
-      connection_send_data(
-          pconn, QByteArrayView(compressed.data(), compressed_size));
-    }
+    conn_send_compressed(pconn,
+                         QByteArrayView(compressed.data(), compressed_size));
   } else {
     log_compress("COMPRESS: would enlarge %lu bytes to %ld; "
                  "sending uncompressed",
@@ -155,6 +245,21 @@ static bool conn_compression_flush(struct connection *pconn)
   return pconn->used;
 }
 
+/**
+   Frees the compression contexts of the connection.
+ */
+void conn_compression_free(struct connection *pconn)
+{
+#ifdef FREECIV_HAVE_LIBZSTD
+  ZSTD_freeCCtx(pconn->compression.zstd_out);
+  pconn->compression.zstd_out = nullptr;
+  ZSTD_freeDCtx(pconn->compression.zstd_in);
+  pconn->compression.zstd_in = nullptr;
+#else
+  Q_UNUSED(pconn);
+#endif
+}
+
 /**
    Thaw the connection. Then maybe compress the data waiting to send them
    to the connection. Returns TRUE on success. See also
@@ -173,6 +278,77 @@ bool conn_compression_thaw(struct connection *pconn)
   return pconn->used;
 }
 
+/**
+   Returns a new serial identifying a delta state, see
+   packet_handler::sent_serial().
+ */
+unsigned packet_delta_next_serial()
+{
+  static unsigned serial = 0;
+
+  if (++serial == 0) {
+    // Zero means no state. Old serials are long gone in practice.
+    serial = 1;
+  }
+  return serial;
+}
+
+/**
+   Sends a packet to all the connections of the list.
+
+   Connections with the same capabilities whose delta state is known to be
+   the same (see packet_handler::sent_serial()) get the same bytes, so the
+   packet is serialized only once for each group of them. Once sent, all
+   the recipients share the new state, which lets the next broadcast to
+   the same connections be serialized only once as well.
+ */
+void lsend_packet(struct conn_list *dest, enum packet_type packet_type,
+                  const void *packet, bool force_to_send)
+{
+  // Serialized packets by capabilities and delta state. Discarded packets
+  // are stored as std::nullopt.
+  std::map<std::pair<packet_capabilities_type, unsigned>,
+           std::optional<QByteArray>>
+      encoded;
+  const unsigned serial = packet_delta_next_serial();
+
+  conn_list_iterate(dest, pconn)
+  {
+    if (!pconn->used) {
+      qCritical("WARNING: trying to send data to the closed connection %s",
+                conn_description(pconn));
+      continue;
+    }
+
+    auto &handler = pconn->phs.handlers[packet_type];
+    if (!handler) {
+      // Not supported by this connection.
+      continue;
+    }
+
+    auto key = std::make_pair(pconn->functional_caps,
+                              handler->sent_serial(packet));
+    auto it = encoded.find(key);
+    if (it == encoded.end()) {
+      QByteArray dout;
+      if (handler->encode(pconn, packet, force_to_send, dout)) {
+        it = encoded.emplace(key, dout).first;
+      } else {
+        it = encoded.emplace(key, std::nullopt).first;
+      }
+    } else if (it->second.has_value()) {
+      // Same state as a connection we already serialized the packet for.
+      handler->adopt(packet);
+    }
+
+    if (it->second.has_value()) {
+      handler->sent(pconn, packet, serial);
+      send_packet(pconn, packet_type, *it->second);
+    }
+  }
+  conn_list_iterate_end;
+}
+
 /**
    It returns the request id of the outgoing packet (or 0 if is_server()).
  */
@@ -243,13 +419,11 @@ int send_packet(struct connection *pc, enum packet_type packet_type,
     connection_send_data(pc, data);
   }
   log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
-                "compression (before/after) = %d/%d",
+                "compression (before/after) = %d/%d "
+                "zstd (before/after) = %d/%d",
                 stat_size_alone, stat_size_no_compression,
-                stat_size_uncompressed, stat_size_compressed);
-  log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
-                "compression (before/after) = %d/%d",
-                stat_size_alone, stat_size_no_compression,
-                stat_size_uncompressed, stat_size_compressed);
+                stat_size_uncompressed, stat_size_compressed,
+                stat_size_zstd_uncompressed, stat_size_zstd_compressed);
 
 #if PACKET_SIZE_STATISTICS
   {
@@ -335,6 +509,101 @@ int send_packet(struct connection *pc, enum packet_type packet_type,
 }
 
 namespace {
+/**
+ * Decompresses a zlib-compressed chunk into \c out. Returns false on
+ * error.
+ */
+bool zlib_decompress(QByteArrayView in, QByteArray &out)
+{
+  uLong compressed_size = in.size();
+  int decompress_factor = 80;
+  uLongf decompressed_size = decompress_factor * compressed_size;
+  int error = Z_DATA_ERROR;
+
+  out.resize(decompressed_size);
+  do {
+    error = uncompress(reinterpret_cast<Bytef *>(out.data()),
+                       &decompressed_size,
+                       reinterpret_cast<const Bytef *>(in.data()),
+                       compressed_size);
+
+    if (error == Z_DATA_ERROR) {
+      decompress_factor += 50;
+      decompressed_size = decompress_factor * compressed_size;
+      out.resize(decompressed_size);
+    }
+
+    if (error != Z_OK) {
+      if (error != Z_DATA_ERROR || decompress_factor > MAX_DECOMPRESSION) {
+        qDebug("Uncompressing of the packet stream failed. "
+               "The connection will be closed now.");
+        return false;
+      }
+    }
+  } while (error != Z_OK);
+
+  out.resize(decompressed_size);
+  return true;
+}
+
+#ifdef FREECIV_HAVE_LIBZSTD
+/**
+ * Decompresses a chunk of the zstd stream of the connection into \c out.
+ * The sender flushes the stream at the end of every chunk, so all the data
+ * can be decoded. Like for zlib, chunks may not expand more than
+ * MAX_DECOMPRESSION times. Returns false on error.
+ */
+bool zstd_decompress(connection *pc, QByteArrayView in, QByteArray &out)
+{
+  const qsizetype max_size = MAX_DECOMPRESSION * in.size();
+
+  if (!pc->compression.zstd) {
+    qDebug("Received a zstd chunk from a connection that didn't negotiate "
+           "it. The connection will be closed now.");
+    return false;
+  }
+
+  if (nullptr == pc->compression.zstd_in) {
+    pc->compression.zstd_in = ZSTD_createDCtx();
+    fc_assert_ret_val(nullptr != pc->compression.zstd_in, false);
+  }
+
+  ZSTD_inBuffer input = {in.data(), size_t(in.size()), 0};
+  size_t produced = 0;
+
+  out.resize(qMax<qsizetype>(4 * in.size(), 4096));
+  while (true) {
+    ZSTD_outBuffer output = {out.data() + produced, out.size() - produced,
+                             0};
+    size_t ret =
+        ZSTD_decompressStream(pc->compression.zstd_in, &output, &input);
+
+    if (ZSTD_isError(ret)) {
+      qDebug("Uncompressing of the packet stream failed (%s). "
+             "The connection will be closed now.",
+             ZSTD_getErrorName(ret));
+      return false;
+    }
+    produced += output.pos;
+    if (input.pos == input.size && output.pos < output.size) {
+      // Everything was decoded and flushed.
+      break;
+    }
+    if (produced == size_t(out.size())) {
+      if (out.size() >= max_size) {
+        qDebug("Uncompressing of the packet stream failed (too large). "
+               "The connection will be closed now.");
+        return false;
+      }
+      out.resize(qMin(2 * out.size(), max_size));
+    }
+  }
+
+  out.resize(produced);
+  return true;
+}
+#endif // FREECIV_HAVE_LIBZSTD
+
 /**
  * Decompresses the connection buffer, leaving it ready to read a packet.
  * Returns 1 on success, 0 if not enough data, -1 on error. Does not close
@@ -378,36 +647,28 @@ int decompress_buffer(connection *pc, QByteArrayView din, int len_read)
     return -1;
   }
 
-  uLong compressed_size = whole_packet_len - header_size;
-  int decompress_factor = 80;
-  unsigned long int decompressed_size = decompress_factor * compressed_size;
-  int error = Z_DATA_ERROR;
+  QByteArrayView compressed(
+      static_cast<const char *>(ADD_TO_POINTER(pc->buffer->data,
+                                               header_size)),
+      whole_packet_len - header_size);
+  QByteArray decompressed;
   struct socket_packet_buffer *buffer = pc->buffer;
-  void *decompressed = fc_malloc(decompressed_size);
 
-  do {
-    error =
-        uncompress(static_cast<Bytef *>(decompressed), &decompressed_size,
-                   static_cast<const Bytef *>(
-                       ADD_TO_POINTER(buffer->data, header_size)),
-                   compressed_size);
-
-    if (error == Z_DATA_ERROR) {
-      decompress_factor += 50;
-      decompressed_size = decompress_factor * compressed_size;
-      decompressed = fc_realloc(decompressed, decompressed_size);
-    }
-
-    if (error != Z_OK) {
-      if (error != Z_DATA_ERROR || decompress_factor > MAX_DECOMPRESSION) {
-        qDebug("Uncompressing of the packet stream failed. "
-               "The connection will be closed now.");
-        free(decompressed);
-        return -1;
-      }
-    }
-  } while (error != Z_OK);
+#ifdef FREECIV_HAVE_LIBZSTD
+  const bool ok =
+      (!compressed.empty()
+               && static_cast<unsigned char>(compressed[0])
+                      == ZSTD_CHUNK_MARKER
+           ? zstd_decompress(pc, compressed.sliced(1), decompressed)
+           : zlib_decompress(compressed, decompressed));
+#else
+  const bool ok = zlib_decompress(compressed, decompressed);
+#endif // FREECIV_HAVE_LIBZSTD
+  if (!ok) {
+    return -1;
+  }
 
+  auto decompressed_size = decompressed.size();
   buffer->ndata -= whole_packet_len;
   /*
    * Remove the packet with the compressed data and shift all the
@@ -430,13 +691,11 @@ int decompress_buffer(connection *pc, QByteArrayView din, int len_read)
   /*
    * Copy the uncompressed data.
    */
-  memcpy(buffer->data, decompressed, decompressed_size);
-
-  free(decompressed);
+  memcpy(buffer->data, decompressed.data(), decompressed_size);
 
   buffer->ndata += decompressed_size;
 
-  log_compress("COMPRESS: decompressed %ld into %ld", compressed_size,
+  log_compress("COMPRESS: decompressed %lld into %lld", compressed.size(),
                decompressed_size);
   return 1;
 }
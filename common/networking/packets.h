@@ -16,6 +16,7 @@
 
 // Qt
 #include <QBitArray>
+#include <QByteArray>
 #include <QByteArrayView>
 #include <QtContainerFwd>        // QVector<QString>
 #include <QtLogging>             // qDebug, qWarning, qCritical
@@ -41,6 +42,35 @@ class packet_handler {
   virtual int send(struct connection *pconn, const void *packet,
                    bool force_to_send) = 0;
 
+  /// Serializes a packet into \c dout and updates the delta state. Returns
+  /// false if the packet is discarded by the delta protocol.
+  virtual bool encode(struct connection *pconn, const void *packet,
+                      bool force_to_send, QByteArray &dout) = 0;
+
+  /**
+   * Identifies the delta state used to send the given packet. Handlers
+   * with the same non-zero serial hold identical states, because they were
+   * last updated together by \ref lsend_packet. Zero means that nothing was
+   * sent yet.
+   */
+  virtual unsigned sent_serial(const void *packet) const
+  {
+    Q_UNUSED(packet);
+    return 0;
+  }
+
+  /// Updates the delta state as \ref encode would, without serializing.
+  virtual void adopt(const void *packet) { Q_UNUSED(packet); }
+
+  /// Called once the packet has been sent, with the new delta state serial.
+  virtual void sent(struct connection *pconn, const void *packet,
+                    unsigned serial)
+  {
+    Q_UNUSED(pconn);
+    Q_UNUSED(packet);
+    Q_UNUSED(serial);
+  }
+
   /// Resets handler state.
   virtual void reset() {}
 
@@ -107,6 +137,10 @@ void packets_deinit();
 
 int send_packet(struct connection *pc, enum packet_type packet_type,
                 QByteArrayView contents);
+void conn_compression_free(struct connection *pconn);
+void lsend_packet(struct conn_list *dest, enum packet_type packet_type,
+                  const void *packet, bool force_to_send);
+unsigned packet_delta_next_serial();
 bool packet_check(QByteArrayView din, struct connection *pc);
 
 void packet_strvec_compute(char str[MAX_LEN_PACKET],
@@ -23,6 +23,7 @@
 template <class T> class packet_delta_handler : public packet_handler {
 protected:
   std::optional<T> last_received, last_sent;
+  unsigned last_sent_serial = 0; ///< See \ref packet_handler::sent_serial
   QBitArray fields;
 
 public:
@@ -33,6 +34,7 @@ template <class T> class packet_delta_handler : public packet_handler {
   {
     last_received = std::nullopt;
     last_sent = std::nullopt;
+    last_sent_serial = 0;
   }
 
   void reset(int key) override
@@ -49,6 +51,8 @@ template <class T> class packet_delta_handler : public packet_handler {
 template <class T> class packet_delta_key_handler : public packet_handler {
 protected:
   std::unordered_map<int, T> receive_map, send_map;
+  /// See \ref packet_handler::sent_serial
+  std::unordered_map<int, unsigned> sent_serials;
   QBitArray fields;
 
 public:
@@ -59,11 +63,13 @@ template <class T> class packet_delta_key_handler : public packet_handler {
   {
     receive_map.clear();
     send_map.clear();
+    sent_serials.clear();
   }
 
   void reset(int key) override
   {
     receive_map.erase(key);
     send_map.erase(key);
+    sent_serials.erase(key);
   }
 };
@@ -547,8 +547,8 @@ static void player_defaults(struct player *pplayer)
 
   pplayer->style = 0;
   pplayer->music_style = -1; // even getting value 0 triggers change
-  pplayer->cities = city_list_new();
-  pplayer->units = unit_list_new();
+  pplayer->cities = city_list_new_pooled();
+  pplayer->units = unit_list_new_pooled();
 
   pplayer->economic.gold = 0;
   pplayer->economic.tax = PLAYER_DEFAULT_TAX_RATE;
@@ -697,6 +697,9 @@ void player_destroy(struct player *pplayer)
   pslot = pplayer->slot;
   fc_assert(pslot->player == pplayer);
 
+  // The address may be reused for another player.
+  effect_cache_invalidate();
+
   delete pplayer->tile_known;
   if (!is_server()) {
     vision_layer_iterate(v)
@@ -805,6 +808,7 @@ bool player_set_nation(struct player *pplayer, struct nation_type *pnation)
       pnation->player = pplayer;
     }
     pplayer->nation = pnation;
+    effect_cache_invalidate();
     return true;
   }
   return false;
@@ -287,6 +287,12 @@ struct player {
 
       struct player_tile *private_map;
 
+      /* Tiles where private_map[tile_index].seen_count[vlayer] and
+       * own_seen[vlayer] are non-zero, for bulk operations on the whole
+       * map. Allocated along with private_map. */
+      QBitArray *tile_seen[V_COUNT];
+      QBitArray *tile_own_seen[V_COUNT];
+
       // Player can see inside his borders.
       bool border_vision;
 
@@ -313,6 +319,9 @@ struct player {
       int huts; // How many huts this player has found
 
       int bulbs_last_turn; // Number of bulbs researched last turn only.
+
+      // Lets clients resume their session, see server/session.cpp.
+      char session_token[MAX_LEN_SESSION_TOKEN]; // not saved
     } server;
 
     struct {
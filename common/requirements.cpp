@@ -48,9 +48,10 @@
 #include <QtPreprocessorSupport> // Q_UNUSED
 
 // std
-#include <cstdarg> // va_*
-#include <cstddef> // size_t
-#include <cstdlib> // atoi
+#include <algorithm> // std::stable_sort
+#include <cstdarg>   // va_*
+#include <cstddef>   // size_t
+#include <cstdlib>   // atoi
 
 const struct action *req_action(const struct req_context *context)
 {
@@ -3206,67 +3207,122 @@ is_achievement_in_range(const struct player *target_player,
 }
 
 /**
- * Checks the requirement to see if it is active on the given target.
- *
- * target gives the type of the target
- * (player,city,building,tile) give the exact target
- * req gives the requirement itself.
- *
- * An attempt is made to derive missing fields from supplied fields. E.g. if
- * 'utype' is missing, it takes it from 'unit' if available. However, it's a
- * good idea to supply specific fields where this would otherwise lead to
- * ambiguous or unexpected outcomes.
+ * The targets of a requirement evaluation, with the blanks that can be
+ * derived from other fields filled in. Filling it is not free, so it is
+ * done once per requirement vector rather than once per requirement.
  */
-bool is_req_active(const struct req_context *target_context,
-                   const struct req_context *other_context,
-                   const struct requirement *req,
-                   const enum req_problem_type prob_type)
+struct req_eval_context {
+  const struct player *target_player;
+  const struct player *other_player;
+  const struct city *target_city;
+  const struct impr_type *target_building;
+  const struct tile *target_tile;
+  const struct unit *target_unit;
+  const struct unit_type *target_unittype;
+  const struct output_type *target_output;
+  const struct specialist *target_specialist;
+  const struct action *target_action;
+  enum vision_layer vision_layer;
+  enum national_intelligence nintel;
+};
+
+/**
+ * Returns the player, city, tile and unit type requirements are evaluated
+ * against in the context. An attempt is made to derive missing fields from
+ * supplied fields. E.g. if 'utype' is missing, it takes it from 'unit' if
+ * available.
+ */
+void req_context_targets(const struct req_context *context,
+                         const struct player **pplayer,
+                         const struct city **pcity,
+                         const struct tile **ptile,
+                         const struct unit_type **putype)
 {
-  const struct player *target_player = req_player(target_context);
-  const struct player *other_player = req_player(other_context);
-  const struct city *target_city = req_city(target_context);
-  const struct impr_type *target_building = req_building(target_context);
-  const struct tile *target_tile = req_tile(target_context);
-  const struct unit *target_unit = req_unit(target_context);
-  const struct unit_type *target_unittype = req_utype(target_context);
-  const struct output_type *target_output = req_output(target_context);
-  const struct specialist *target_specialist =
-      req_specialist(target_context);
-  const struct action *target_action = req_action(target_context);
-  const enum vision_layer vision_layer = req_vision_layer(target_context);
-  const enum national_intelligence nintel = req_nintel(target_context);
-  enum fc_tristate eval = TRI_NO;
+  *pplayer = req_player(context);
+  *pcity = req_city(context);
+  *ptile = req_tile(context);
+  *putype = req_utype(context);
 
   // Fill in some blanks that can be derived from other fields.
-  if (!target_city) {
-    if (req_tile(target_context)) {
-      target_city = tile_city(req_tile(target_context));
-    } else if (req_unit(target_context)) {
-      target_city = tile_city(unit_tile(req_unit(target_context)));
+  if (!*pcity) {
+    if (req_tile(context)) {
+      *pcity = tile_city(req_tile(context));
+    } else if (req_unit(context)) {
+      *pcity = tile_city(unit_tile(req_unit(context)));
     }
   }
 
-  if (!target_tile) {
-    if (req_unit(target_context)) {
-      target_tile = unit_tile(req_unit(target_context));
-    } else if (req_city(target_context)) {
-      target_tile = city_tile(req_city(target_context));
+  if (!*ptile) {
+    if (req_unit(context)) {
+      *ptile = unit_tile(req_unit(context));
+    } else if (req_city(context)) {
+      *ptile = city_tile(req_city(context));
     }
   }
 
-  if (!target_player) {
-    if (req_unit(target_context)) {
-      target_player = unit_owner(req_unit(target_context));
-    } else if (req_city(target_context)) {
-      target_player = city_owner(req_city(target_context));
-    } else if (req_tile(target_context)) {
-      target_player = tile_owner(req_tile(target_context));
+  if (!*pplayer) {
+    if (req_unit(context)) {
+      *pplayer = unit_owner(req_unit(context));
+    } else if (req_city(context)) {
+      *pplayer = city_owner(req_city(context));
+    } else if (req_tile(context)) {
+      *pplayer = tile_owner(req_tile(context));
     }
   }
 
-  if (!target_unittype && target_unit) {
-    target_unittype = unit_type_get(target_unit);
+  if (!*putype && req_unit(context)) {
+    *putype = unit_type_get(req_unit(context));
   }
+}
+
+/**
+ * Fills ctx from the given requirement contexts.
+ *
+ * An attempt is made to derive missing fields from supplied fields. E.g. if
+ * 'utype' is missing, it takes it from 'unit' if available.
+ */
+static void req_eval_context_fill(struct req_eval_context *ctx,
+                                  const struct req_context *target_context,
+                                  const struct req_context *other_context)
+{
+  ctx->target_player = req_player(target_context);
+  ctx->other_player = req_player(other_context);
+  ctx->target_city = req_city(target_context);
+  ctx->target_building = req_building(target_context);
+  ctx->target_tile = req_tile(target_context);
+  ctx->target_unit = req_unit(target_context);
+  ctx->target_unittype = req_utype(target_context);
+  ctx->target_output = req_output(target_context);
+  ctx->target_specialist = req_specialist(target_context);
+  ctx->target_action = req_action(target_context);
+  ctx->vision_layer = req_vision_layer(target_context);
+  ctx->nintel = req_nintel(target_context);
+
+  req_context_targets(target_context, &ctx->target_player,
+                      &ctx->target_city, &ctx->target_tile,
+                      &ctx->target_unittype);
+}
+
+/**
+ * Checks the requirement to see if it is active on the filled in targets.
+ */
+static bool is_req_active_in(const struct req_eval_context *ctx,
+                             const struct requirement *req,
+                             const enum req_problem_type prob_type)
+{
+  const struct player *target_player = ctx->target_player;
+  const struct player *other_player = ctx->other_player;
+  const struct city *target_city = ctx->target_city;
+  const struct impr_type *target_building = ctx->target_building;
+  const struct tile *target_tile = ctx->target_tile;
+  const struct unit *target_unit = ctx->target_unit;
+  const struct unit_type *target_unittype = ctx->target_unittype;
+  const struct output_type *target_output = ctx->target_output;
+  const struct specialist *target_specialist = ctx->target_specialist;
+  const struct action *target_action = ctx->target_action;
+  const enum vision_layer vision_layer = ctx->vision_layer;
+  const enum national_intelligence nintel = ctx->nintel;
+  enum fc_tristate eval = TRI_NO;
 
   /* Note the target may actually not exist.  In particular, effects that
    * have a VUT_TERRAIN may often be passed
@@ -3625,6 +3681,30 @@ bool is_req_active(const struct req_context *target_context,
   }
 }
 
+/**
+ * Checks the requirement to see if it is active on the given target.
+ *
+ * target gives the type of the target
+ * (player,city,building,tile) give the exact target
+ * req gives the requirement itself.
+ *
+ * An attempt is made to derive missing fields from supplied fields. E.g. if
+ * 'utype' is missing, it takes it from 'unit' if available. However, it's a
+ * good idea to supply specific fields where this would otherwise lead to
+ * ambiguous or unexpected outcomes.
+ */
+bool is_req_active(const struct req_context *target_context,
+                   const struct req_context *other_context,
+                   const struct requirement *req,
+                   const enum req_problem_type prob_type)
+{
+  struct req_eval_context ctx;
+
+  req_eval_context_fill(&ctx, target_context, other_context);
+
+  return is_req_active_in(&ctx, req, prob_type);
+}
+
 /**
  * This function is deprecated. If you want to add new parameters, switch to
  * using are_reqs_active by req_context.
@@ -3677,9 +3757,17 @@ bool are_reqs_active(const struct req_context *target_context,
                      const struct requirement_vector *reqs,
                      const enum req_problem_type prob_type)
 {
+  struct req_eval_context ctx;
+
+  if (requirement_vector_size(reqs) == 0) {
+    return true;
+  }
+
+  req_eval_context_fill(&ctx, target_context, other_context);
+
   requirement_vector_iterate(reqs, preq)
   {
-    if (!is_req_active(target_context, other_context, preq, prob_type)) {
+    if (!is_req_active_in(&ctx, preq, prob_type)) {
       return false;
     }
   }
@@ -3687,6 +3775,140 @@ bool are_reqs_active(const struct req_context *target_context,
   return true;
 }
 
+/**
+ * Returns a rough estimate of how expensive evaluating the requirement is.
+ * 0 is a comparison with the target, 1 a lookup and 2 a scan over tiles,
+ * cities, players or techs.
+ */
+static int req_eval_cost(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_NONE:
+  case VUT_ACTION:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_GOVERNMENT:
+  case VUT_AI_LEVEL:
+  case VUT_IMPR_GENUS:
+  case VUT_STYLE:
+  case VUT_MINSIZE:
+  case VUT_MINVETERAN:
+  case VUT_MINMOVES:
+  case VUT_MINHP:
+  case VUT_ACTIVITY:
+  case VUT_MINYEAR:
+  case VUT_MINCALFRAG:
+  case VUT_TOPO:
+  case VUT_VISIONLAYER:
+  case VUT_NINTEL:
+    return 0;
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_EXTRA:
+  case VUT_EXTRAFLAG:
+  case VUT_ROADFLAG:
+  case VUT_BASEFLAG:
+    switch (req->range) {
+    case REQ_RANGE_LOCAL:
+      return 0;
+    case REQ_RANGE_CADJACENT:
+    case REQ_RANGE_ADJACENT:
+      return 1;
+    default:
+      return 2;
+    }
+  case VUT_TECHFLAG:
+  case VUT_DIPLREL:
+  case VUT_MAXTILEUNITS:
+  case VUT_MINCULTURE:
+  case VUT_MINFOREIGNPCT:
+  case VUT_NATIONALITY:
+    return 2;
+  default:
+    switch (req->range) {
+    case REQ_RANGE_CONTINENT:
+    case REQ_RANGE_TRADEROUTE:
+    case REQ_RANGE_TEAM:
+    case REQ_RANGE_ALLIANCE:
+      return 2;
+    default:
+      return 1;
+    }
+  }
+}
+
+/**
+ * Prepares the requirement vector for evaluation by are_reqs_active() with
+ * a plan. Requirements that are always met are dropped, and the rest is
+ * ordered by evaluation cost so that the first failing requirement is
+ * usually found cheaply. Requirements of the same cost keep the ruleset
+ * order.
+ *
+ * Unchanging requirements (see is_req_unchanging()) cannot be folded: they
+ * still depend on the target, or on settings changed after ruleset load.
+ */
+void req_plan_compile(struct requirement_plan *plan,
+                      const struct requirement_vector *reqs)
+{
+  plan->never = false;
+  plan->reqs.clear();
+
+  requirement_vector_iterate(reqs, preq)
+  {
+    if (preq->source.kind == VUT_NONE) {
+      // Always met when present, never when not.
+      plan->never = plan->never || !preq->present;
+      continue;
+    }
+    plan->reqs.push_back(*preq);
+  }
+  requirement_vector_iterate_end;
+
+  std::stable_sort(plan->reqs.begin(), plan->reqs.end(),
+                   [](const requirement &req1, const requirement &req2) {
+                     return req_eval_cost(&req1) < req_eval_cost(&req2);
+                   });
+
+  plan->compiled = true;
+}
+
+/**
+ * Checks the compiled requirement vector to see if it is active on the
+ * given target. Gives the same result as are_reqs_active() on the vector
+ * the plan was compiled from.
+ */
+bool are_reqs_active(const struct req_context *target_context,
+                     const struct req_context *other_context,
+                     const struct requirement_plan *plan,
+                     const enum req_problem_type prob_type)
+{
+  struct req_eval_context ctx;
+
+  fc_assert_ret_val(plan->compiled, false);
+
+  if (plan->never) {
+    return false;
+  }
+  if (plan->reqs.empty()) {
+    return true;
+  }
+
+  req_eval_context_fill(&ctx, target_context, other_context);
+
+  for (const auto &req : plan->reqs) {
+    if (!is_req_active_in(&ctx, &req, prob_type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /**
    Return TRUE if this is an "unchanging" requirement.  This means that
    if a target can't meet the requirement now, it probably won't ever be able
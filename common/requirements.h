@@ -14,6 +14,7 @@ class QString;
 
 // std
 #include <cstddef> // size_t
+#include <vector>
 
 #define req_range_iterate(_range_)                                          \
   {                                                                         \
@@ -32,6 +33,18 @@ class QString;
   TYPED_VECTOR_ITERATE(struct requirement, req_vec, preq)
 #define requirement_vector_iterate_end VECTOR_ITERATE_END
 
+/**
+ * A requirement vector prepared for fast evaluation by req_plan_compile().
+ * It must be compiled again when the vector it was made from changes.
+ */
+struct requirement_plan {
+  bool compiled = false;
+  // Contains a requirement that can never be met.
+  bool never = false;
+  // Requirements that may fail, cheapest first.
+  std::vector<struct requirement> reqs;
+};
+
 /**
  * A set of targets to evaluate requirements against. Depending on what the
  * requirements in question are for, most of these entries will usually be
@@ -69,6 +82,11 @@ const struct tile *req_tile(const struct req_context *context);
 const struct unit *req_unit(const struct req_context *context);
 const struct unit_type *req_utype(const struct req_context *context);
 const enum vision_layer req_vision_layer(const struct req_context *context);
+void req_context_targets(const struct req_context *context,
+                         const struct player **pplayer,
+                         const struct city **pcity,
+                         const struct tile **ptile,
+                         const struct unit_type **putype);
 
 // General requirement functions.
 struct requirement req_from_str(const char *type, const char *range,
@@ -121,6 +139,12 @@ bool are_reqs_active(const struct req_context *target_context,
                      const struct req_context *other_context,
                      const struct requirement_vector *reqs,
                      const enum req_problem_type prob_type);
+bool are_reqs_active(const struct req_context *target_context,
+                     const struct req_context *other_context,
+                     const struct requirement_plan *plan,
+                     const enum req_problem_type prob_type);
+void req_plan_compile(struct requirement_plan *plan,
+                      const struct requirement_vector *reqs);
 
 bool is_req_unchanging(const struct requirement *req);
 
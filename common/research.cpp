@@ -497,6 +497,9 @@ void research_update(struct research *presearch)
 {
   int techs_researched;
 
+  // Techs may have been set directly.
+  effect_cache_invalidate();
+
   advance_index_iterate(A_FIRST, i)
   {
     enum tech_state state = presearch->inventions[i].state;
@@ -644,6 +647,7 @@ enum tech_state research_invention_set(struct research *presearch,
     return old;
   }
   presearch->inventions[tech].state = value;
+  effect_cache_invalidate();
 
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
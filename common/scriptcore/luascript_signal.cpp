@@ -25,6 +25,10 @@
     return false
 
   If the value is 'true' the current signal emission will be stopped.
+
+  Code emitting a signal often can look it up once with
+  luascript_signal_find() and emit it through the returned handle. An
+  emission without connected callbacks returns right away.
  */
 
 // self
@@ -40,6 +44,7 @@
 #include "luascript_types.h"
 
 // Qt
+#include <QElapsedTimer>
 #include <QHash>
 #include <QList>
 #include <QLoggingCategory> // qCWarning
@@ -86,6 +91,9 @@ static struct signal *signal_new(int nargs, enum api_types *parg_types)
   psignal->arg_types = parg_types;
   psignal->callbacks = new QList<signal_callback *>;
   psignal->depr_msg = nullptr;
+  psignal->emitted = 0;
+  psignal->invoked = 0;
+  psignal->nsecs = 0;
 
   return psignal;
 }
@@ -105,30 +113,69 @@ static void signal_destroy(struct signal *psignal)
   delete psignal;
 }
 
+/**
+   Return the signal called 'signal_name', or nullptr if there is none. The
+   handle stays valid until luascript_signal_free().
+ */
+struct signal *luascript_signal_find(struct fc_lua *fcl,
+                                     const char *signal_name)
+{
+  fc_assert_ret_val(fcl, nullptr);
+  fc_assert_ret_val(fcl->signals_hash, nullptr);
+
+  return fcl->signals_hash->value(signal_name, nullptr);
+}
+
+/**
+   Invoke all the callback functions attached to a signal given by its
+   handle.
+ */
+void luascript_signal_emit_handle_valist(struct fc_lua *fcl,
+                                         struct signal *psignal,
+                                         va_list args)
+{
+  fc_assert_ret(psignal);
+
+  psignal->emitted++;
+  if (psignal->callbacks->isEmpty()) {
+    return;
+  }
+
+  fc_assert_ret(fcl);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  /* Iterate over a copy: callbacks may connect or remove callbacks of the
+   * signal they are invoked for. */
+  const auto callbacks = *psignal->callbacks;
+  for (auto *pcallback : callbacks) {
+    va_list args_cb;
+    bool stop;
+
+    va_copy(args_cb, args);
+    psignal->invoked++;
+    stop = luascript_callback_invoke(fcl, pcallback->name, psignal->nargs,
+                                     psignal->arg_types, args_cb);
+    va_end(args_cb);
+    if (stop) {
+      break;
+    }
+  }
+
+  psignal->nsecs += timer.nsecsElapsed();
+}
+
 /**
    Invoke all the callback functions attached to a given signal.
  */
 void luascript_signal_emit_valist(struct fc_lua *fcl,
                                   const char *signal_name, va_list args)
 {
-  struct signal *psignal;
+  struct signal *psignal = luascript_signal_find(fcl, signal_name);
 
-  fc_assert_ret(fcl);
-  fc_assert_ret(fcl->signals_hash);
-
-  psignal = fcl->signals_hash->value(signal_name, nullptr);
   if (psignal) {
-    for (auto *pcallback : std::as_const(*psignal->callbacks)) {
-      va_list args_cb;
-
-      va_copy(args_cb, args);
-      if (luascript_callback_invoke(fcl, pcallback->name, psignal->nargs,
-                                    psignal->arg_types, args_cb)) {
-        va_end(args_cb);
-        break;
-      }
-      va_end(args_cb);
-    }
+    luascript_signal_emit_handle_valist(fcl, psignal, args);
   } else {
     luascript_log(fcl, LOG_ERROR,
                   "Signal \"%s\" does not exist, so cannot "
@@ -30,6 +30,11 @@ struct signal {
   enum api_types *arg_types;           // argument types
   QList<signal_callback *> *callbacks; // connected callbacks
   char *depr_msg; // deprecation message to show if handler added
+
+  // Statistics
+  unsigned emitted; // number of emissions
+  unsigned invoked; // number of callback invocations
+  qint64 nsecs;     // time spent in callbacks
 };
 
 void luascript_signal_init(struct fc_lua *fcl);
@@ -38,6 +43,11 @@ void luascript_signal_free(struct fc_lua *fcl);
 void luascript_signal_emit_valist(struct fc_lua *fcl,
                                   const char *signal_name, va_list args);
 void luascript_signal_emit(struct fc_lua *fcl, const char *signal_name, ...);
+struct signal *luascript_signal_find(struct fc_lua *fcl,
+                                     const char *signal_name);
+void luascript_signal_emit_handle_valist(struct fc_lua *fcl,
+                                         struct signal *psignal,
+                                         va_list args);
 signal_deprecator *luascript_signal_create(struct fc_lua *fcl,
                                            const char *signal_name,
                                            int nargs, ...);
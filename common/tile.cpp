@@ -13,6 +13,7 @@
 // common
 #include "base.h"
 #include "city.h"
+#include "effects.h"
 #include "extras.h"
 #include "fc_interface.h"
 #include "fc_types.h"
@@ -35,6 +36,19 @@
 
 static bv_extras empty_extras;
 
+/**
+   Return the hot field arrays of the map if ptile is one of its tiles, or
+   nullptr for virtual tiles (which may carry the index of a real tile).
+ */
+static struct tile_hot_fields *tile_hot(const struct tile *ptile)
+{
+  if (wld.map.hot == nullptr || ptile->index == TILE_INDEX_NONE
+      || ptile != wld.map.tiles + ptile->index) {
+    return nullptr;
+  }
+  return wld.map.hot;
+}
+
 #ifndef tile_index
 /**
    Return the tile index.
@@ -70,6 +84,11 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
       || (tile_city(ptile) != nullptr || ptile->owner != nullptr)) {
     ptile->owner = pplayer;
     ptile->claimer = claimer;
+
+    if (auto hot = tile_hot(ptile)) {
+      hot->owner[ptile->index] =
+          pplayer != nullptr ? player_number(pplayer) : -1;
+    }
   }
 }
 
@@ -148,6 +167,12 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
       BV_CLR(ptile->extras, extra_index(ptile->resource));
     }
   }
+  if (auto hot = tile_hot(ptile)) {
+    hot->terrain[ptile->index] =
+        pterrain != T_UNKNOWN ? terrain_number(pterrain) : -1;
+    hot->extras[ptile->index] = ptile->extras;
+  }
+  effect_cache_invalidate();
 }
 
 /**
@@ -395,6 +420,12 @@ Continent_id tile_continent(const struct tile *ptile)
 void tile_set_continent(struct tile *ptile, Continent_id val)
 {
   ptile->continent = val;
+
+  if (auto hot = tile_hot(ptile)) {
+    hot->continent[ptile->index] = val;
+  }
+  // Buildings can have continent range.
+  effect_cache_invalidate();
 }
 
 /**
@@ -995,6 +1026,10 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != nullptr) {
     BV_SET(ptile->extras, extra_index(pextra));
+    if (auto hot = tile_hot(ptile)) {
+      BV_SET(hot->extras[ptile->index], extra_index(pextra));
+    }
+    effect_cache_invalidate();
   }
 }
 
@@ -1005,7 +1040,23 @@ void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != nullptr) {
     BV_CLR(ptile->extras, extra_index(pextra));
+    if (auto hot = tile_hot(ptile)) {
+      BV_CLR(hot->extras[ptile->index], extra_index(pextra));
+    }
+    effect_cache_invalidate();
+  }
+}
+
+/**
+   Replaces all extras of the tile.
+ */
+void tile_set_extras(struct tile *ptile, const bv_extras *extras)
+{
+  ptile->extras = *extras;
+  if (auto hot = tile_hot(ptile)) {
+    hot->extras[ptile->index] = *extras;
   }
+  effect_cache_invalidate();
 }
 
 /**
@@ -1076,6 +1127,9 @@ void tile_virtual_destroy(struct tile *vtile)
     return;
   }
 
+  // The address may be reused for another tile.
+  effect_cache_invalidate();
+
   if (vtile->units) {
     unit_list_iterate(vtile->units, vunit)
     {
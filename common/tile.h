@@ -121,6 +121,7 @@ bool tile_has_visible_extra(const struct tile *ptile,
                             const struct extra_type *pextra);
 void tile_add_extra(struct tile *ptile, const struct extra_type *pextra);
 void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra);
+void tile_set_extras(struct tile *ptile, const bv_extras *extras);
 bool tile_has_extra_flag(const struct tile *ptile, enum extra_flag_id flag);
 ;
 
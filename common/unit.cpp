@@ -1596,6 +1596,9 @@ void unit_virtual_destroy(struct unit *punit)
 {
   free_unit_orders(punit);
 
+  // The address may be reused for another unit.
+  effect_cache_invalidate();
+
   // Unload unit if transported.
   unit_transport_unload(punit);
   fc_assert(!unit_transported(punit));
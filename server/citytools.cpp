@@ -59,6 +59,7 @@
 #include "sanitycheck.h"
 #include "sernet.h"
 #include "server_connection.h"
+#include "session.h"
 #include "srv_main.h"
 #include "techtools.h"
 #include "unithand.h"
@@ -1209,6 +1210,8 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
 
   pcity->owner = ptaker;
   pcity->capital = CAPITAL_NOT;
+  // Buildings were restored behind city_add_improvement()'s back.
+  effect_cache_invalidate();
   map_claim_ownership(pcenter, ptaker, pcenter, true);
   city_list_prepend(ptaker->cities, pcity);
 
@@ -1672,7 +1675,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
 
   sanity_check_city(pcity);
 
-  script_server_signal_emit("city_built", pcity);
+  script_server_signal_emit(SSIG_CITY_BUILT, pcity);
 
   CALL_FUNC_EACH_AI(city_created, pcity);
   CALL_PLR_AI_FUNC(city_got, pplayer, pplayer, pcity);
@@ -2018,7 +2021,7 @@ bool unit_conquer_city(struct unit *punit, struct city *pcity)
     notify_player(cplayer, city_tile(pcity), E_CITY_LOST, ftc_server,
                   _("%s has been destroyed by %s."), city_tile_link(pcity),
                   player_name(pplayer));
-    script_server_signal_emit("city_destroyed", pcity, cplayer, pplayer);
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, cplayer, pplayer);
 
     // We cant't be sure of city existence after running some script
     if (city_exist(pcity_id)) {
@@ -2046,7 +2049,7 @@ bool unit_conquer_city(struct unit *punit, struct city *pcity)
   }
 
   int conquestTechPct = get_unit_bonus(punit, EFT_CONQUEST_TECH_PCT);
-  script_server_signal_emit("city_loot", pcity, punit);
+  script_server_signal_emit(SSIG_CITY_LOOT, pcity, punit);
   bool city_remains = city_exist(pcity_id);
 
   if (fc_rand(100) < conquestTechPct) {
@@ -2073,9 +2076,9 @@ bool unit_conquer_city(struct unit *punit, struct city *pcity)
   }
 
   if (city_remains) {
-    script_server_signal_emit("city_transferred", pcity, cplayer, pplayer,
+    script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, cplayer, pplayer,
                               "conquest");
-    script_server_signal_emit("city_lost", pcity, cplayer, pplayer);
+    script_server_signal_emit(SSIG_CITY_LOST, pcity, cplayer, pplayer);
   }
 
   return true;
@@ -2111,6 +2114,7 @@ static void package_dumb_city(struct player *pplayer, struct tile *ptile,
   const vision_site *pdcity = map_get_player_city(ptile, pplayer);
 
   fc_assert_ret(pdcity != nullptr);
+  session_tile_changed(ptile);
   packet->id = pdcity->identity;
   packet->owner = player_number(vision_site_owner(pdcity));
   packet->tile = tile_index(ptile);
@@ -2411,6 +2415,8 @@ void package_city(struct city *pcity, struct packet_city_info *packet,
   int i;
   int ppl = 0;
 
+  session_tile_changed(city_tile(pcity));
+
   packet->id = pcity->id;
   packet->owner = player_number(city_owner(pcity));
   packet->tile = tile_index(city_tile(pcity));
@@ -2679,6 +2685,7 @@ void reality_check_city(struct player *pplayer, struct tile *ptile)
     struct city *pcity = tile_city(ptile);
 
     if (!pcity || pcity->id != playtile->site->identity) {
+      session_city_removed(playtile->site->identity);
       dlsend_packet_city_remove(pplayer->connections,
                                 playtile->site->identity);
       playtile->site = nullptr;
@@ -2694,6 +2701,7 @@ void remove_dumb_city(struct player *pplayer, struct tile *ptile)
   auto playtile = map_get_player_tile(ptile, pplayer);
 
   if (playtile->site && playtile->site->location == ptile) {
+    session_city_removed(playtile->site->identity);
     dlsend_packet_city_remove(pplayer->connections,
                               playtile->site->identity);
     playtile->site = nullptr;
@@ -2836,7 +2844,7 @@ bool signal_building_lost(struct city *pcity,
   fc_assert_ret_val(pimprove, true);
   fc_assert_ret_val(reason, true);
   int city_id = pcity->id;
-  script_server_signal_emit("building_lost", pcity, pimprove, reason,
+  script_server_signal_emit(SSIG_BUILDING_LOST, pcity, pimprove, reason,
                             destroyer);
   return city_exist(city_id);
 }
@@ -2956,7 +2964,7 @@ bool signal_building_built(struct city *pcity,
   fc_assert_ret_val(pcity, true);
   fc_assert_ret_val(pimprove, true);
   int city_id = pcity->id;
-  script_server_signal_emit("building_built", pimprove, pcity);
+  script_server_signal_emit(SSIG_BUILDING_BUILT, pimprove, pcity);
   return city_exist(city_id);
 }
 
@@ -3449,6 +3457,10 @@ bool city_map_update_radius_sq(struct city *pcity)
   citylog_map_workers(LOG_DEBUG, pcity);
 
   city_map_radius_sq_set(pcity, city_radius_sq_new);
+  // The tiles permanently claimed by the city change.
+  map_borders_dirty(city_tile(pcity),
+                    MAX(city_radius_sq_old, city_radius_sq_new)
+                        + game.info.border_city_permanent_radius_sq);
 
   if (city_tiles_old < city_tiles_new) {
     // increased number of city tiles
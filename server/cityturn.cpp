@@ -13,6 +13,10 @@
 
 #include <cmath> // exp, sqrt
 #include <cstring>
+#include <vector>
+
+// Qt
+#include <QSet>
 
 // utility
 #include "fcintl.h"
@@ -72,8 +76,11 @@
 /* server/scripting */
 #include "script_server.h"
 
-// Queue for pending city_refresh()
-static struct city_list *city_refresh_queue = nullptr;
+/* Queue for pending city_refresh(), by city id. Cities may go away while
+ * queued, and are processed most recently queued first. */
+static std::vector<int> city_refresh_queue;
+static QSet<int> city_refresh_queued;
+static int city_refresh_queue_frozen = 0;
 
 /* The game is currently considering to remove the listed units because of
  * missing gold upkeep. A unit ends up here if it has gold upkeep that
@@ -190,39 +197,79 @@ void city_refresh_for_player(struct player *pplayer)
  */
 void city_refresh_queue_add(struct city *pcity)
 {
-  if (nullptr == city_refresh_queue) {
-    city_refresh_queue = city_list_new();
-  } else if (city_list_find_number(city_refresh_queue, pcity->id)) {
-    return;
+  if (!city_refresh_queued.contains(pcity->id)) {
+    city_refresh_queue.push_back(pcity->id);
+    city_refresh_queued.insert(pcity->id);
   }
 
-  city_list_prepend(city_refresh_queue, pcity);
   pcity->server.needs_refresh = true;
 }
 
+/**
+   Delay city_refresh_queue_processing() until the matching
+   city_refresh_queue_thaw(), so that a city touched by several changes is
+   only refreshed and sent once. Calls can be nested.
+ */
+void city_refresh_queue_freeze() { city_refresh_queue_frozen++; }
+
+/**
+   Undo city_refresh_queue_freeze(). Processes the queue once the last
+   freeze is gone.
+ */
+void city_refresh_queue_thaw()
+{
+  city_refresh_queue_frozen--;
+  fc_assert(city_refresh_queue_frozen >= 0);
+  city_refresh_queue_processing();
+}
+
 /**
    Refresh the listed cities.
    Called after significant changes to borders, and arranging workers.
+
+   All the queued cities are refreshed first, then the workers of those
+   that need it are arranged, and finally the cities are sent.
  */
 void city_refresh_queue_processing()
 {
-  if (nullptr == city_refresh_queue) {
+  std::vector<struct city *> cities, arrange;
+
+  if (city_refresh_queue_frozen > 0 || city_refresh_queue.empty()) {
     return;
   }
 
-  city_list_iterate(city_refresh_queue, pcity)
-  {
-    if (pcity->server.needs_refresh) {
-      if (city_refresh(pcity)) {
-        auto_arrange_workers(pcity);
-      }
-      send_city_info(city_owner(pcity), pcity);
+  cities.reserve(city_refresh_queue.size());
+  for (auto it = city_refresh_queue.rbegin();
+       it != city_refresh_queue.rend(); ++it) {
+    struct city *pcity = game_city_by_number(*it);
+
+    if (pcity != nullptr && pcity->server.needs_refresh) {
+      cities.push_back(pcity);
     }
   }
-  city_list_iterate_end;
+  city_refresh_queue.clear();
+  city_refresh_queued.clear();
+
+  TIMING_LOG(AIT_CITY_REFRESH, TIMER_START);
+  for (auto *pcity : cities) {
+    if (city_refresh(pcity)) {
+      arrange.push_back(pcity);
+    }
+  }
+  TIMING_LOG(AIT_CITY_REFRESH, TIMER_STOP);
+  TIMING_COUNT(AIT_CITY_REFRESH, (int) cities.size());
+
+  // Timed as AIT_CITIZEN_ARRANGE.
+  for (auto *pcity : arrange) {
+    auto_arrange_workers(pcity);
+  }
 
-  city_list_destroy(city_refresh_queue);
-  city_refresh_queue = nullptr;
+  TIMING_LOG(AIT_CITY_SEND, TIMER_START);
+  for (auto *pcity : cities) {
+    send_city_info(city_owner(pcity), pcity);
+  }
+  TIMING_LOG(AIT_CITY_SEND, TIMER_STOP);
+  TIMING_COUNT(AIT_CITY_SEND, (int) cities.size());
 }
 
 /**
@@ -370,6 +417,7 @@ void auto_arrange_workers(struct city *pcity)
     return;
   }
   TIMING_LOG(AIT_CITIZEN_ARRANGE, TIMER_START);
+  TIMING_COUNT(AIT_CITIZEN_ARRANGE, 1);
 
   /* Freeze the workers and make sure all the tiles around the city
    * are up to date.  Then thaw, but hackishly make sure that thaw
@@ -842,7 +890,7 @@ bool city_reduce_size(struct city *pcity, citizens pop_loss,
   }
 
   if (city_size_get(pcity) <= pop_loss) {
-    script_server_signal_emit("city_destroyed", pcity, pcity->owner,
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, pcity->owner,
                               destroyer);
 
     remove_city(pcity);
@@ -899,7 +947,8 @@ bool city_reduce_size(struct city *pcity, citizens pop_loss,
   if (reason != nullptr) {
     int id = pcity->id;
 
-    script_server_signal_emit("city_size_change", pcity, -pop_loss, reason);
+    script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, -pop_loss,
+                              reason);
 
     return city_exist(id);
   }
@@ -984,7 +1033,7 @@ static void city_reset_foodbox(struct city *pcity, int new_size)
 static bool city_increase_size(struct city *pcity,
                                struct player *nationality)
 {
-  int new_food;
+  int new_food, old_radius_sq;
   int savings_pct = granary_savings(pcity);
   bool have_square = false;
   struct tile *pcenter = city_tile(pcity);
@@ -1018,7 +1067,12 @@ static bool city_increase_size(struct city *pcity,
   }
 
   city_reset_foodbox(pcity, city_size_get(pcity) + 1);
+  old_radius_sq = tile_border_source_radius_sq(pcenter);
   city_size_add(pcity, 1);
+  /* The border strength of the city changes with its size. The borders
+   * are reclaimed at turn end. */
+  map_borders_dirty(pcenter, MAX(old_radius_sq,
+                                 tile_border_source_radius_sq(pcenter)));
 
   /* If there is enough food, and the city is big enough,
    * make new citizens into scientists or taxmen -- Massimo */
@@ -1070,7 +1124,7 @@ static bool city_increase_size(struct city *pcity,
   /* Deprecated signal. Connect your lua functions to "city_size_change"
    * that's emitted from calling functions which know the 'reason' of the
    * increase. */
-  script_server_signal_emit("city_growth", pcity, city_size_get(pcity));
+  script_server_signal_emit(SSIG_CITY_GROWTH, pcity, city_size_get(pcity));
   if (city_exist(saved_id)) {
     // Script didn't destroy this city
     sanity_check_city(pcity);
@@ -1103,7 +1157,7 @@ bool city_change_size(struct city *pcity, citizens size,
     if (real_change != 0 && reason != nullptr) {
       int id = pcity->id;
 
-      script_server_signal_emit("city_size_change", pcity, real_change,
+      script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, real_change,
                                 reason);
 
       if (!city_exist(id)) {
@@ -1151,7 +1205,7 @@ static void city_populate(struct city *pcity, struct player *nationality)
       map_claim_border(pcity->tile, pcity->owner, -1);
 
       if (success) {
-        script_server_signal_emit("city_size_change", pcity, 1, "growth");
+        script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, 1, "growth");
       }
     }
   } else if (pcity->food_stock < 0) {
@@ -1972,7 +2026,7 @@ static bool worklist_change_build_target(struct player *pplayer,
                           "tech %s not yet available. Postponing..."),
                         city_link(pcity), utype_name_translation(ptarget),
                         advance_name_translation(ptarget->require_advance));
-          script_server_signal_emit("unit_cant_be_built", ptarget, pcity,
+          script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, ptarget, pcity,
                                     "need_tech");
         } else {
           // Unknown or requirement from vector.
@@ -1996,7 +2050,7 @@ static bool worklist_change_build_target(struct player *pplayer,
                          in the worklist, not its obsolete-closure
                          pupdate. */
                       utype_name_translation(ptarget));
-        script_server_signal_emit("unit_cant_be_built", ptarget, pcity,
+        script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, ptarget, pcity,
                                   "never");
         if (city_exist(saved_id)) {
           city_checked = true;
@@ -2058,8 +2112,8 @@ static bool worklist_change_build_target(struct player *pplayer,
                       _("%s can't build %s from the worklist. Purging..."),
                       city_link(pcity),
                       city_improvement_name_translation(pcity, ptarget));
-        script_server_signal_emit("building_cant_be_built", ptarget, pcity,
-                                  "never");
+        script_server_signal_emit(SSIG_BUILDING_CANT_BE_BUILT, ptarget,
+                                  pcity, "never");
         if (city_exist(saved_id)) {
           city_checked = true;
           // Purge this worklist item.
@@ -2340,7 +2394,7 @@ static bool city_build_building(struct player *pplayer, struct city *pcity)
                   _("%s is building %s, which is no longer available."),
                   city_link(pcity),
                   city_improvement_name_translation(pcity, pimprove));
-    script_server_signal_emit("building_cant_be_built", pimprove, pcity,
+    script_server_signal_emit(SSIG_BUILDING_CANT_BE_BUILT, pimprove, pcity,
                               "unavailable");
     return true;
   }
@@ -2393,7 +2447,7 @@ static bool city_build_building(struct player *pplayer, struct city *pcity)
     notify_player(pplayer, city_tile(pcity), E_IMP_BUILD, ftc_server,
                   _("%s has finished building %s."), city_link(pcity),
                   improvement_name_translation(pimprove));
-    script_server_signal_emit("building_built", pimprove, pcity);
+    script_server_signal_emit(SSIG_BUILDING_BUILT, pimprove, pcity);
 
     if (!city_exist(saved_id)) {
       // Script removed city
@@ -2501,7 +2555,7 @@ static struct unit *city_create_unit(struct city *pcity,
   }
 
   /* This might destroy pcity and/or punit: */
-  script_server_signal_emit("unit_built", punit, pcity);
+  script_server_signal_emit(SSIG_UNIT_BUILT, punit, pcity);
 
   if (unit_is_alive(saved_unit_id)) {
     return punit;
@@ -2548,7 +2602,7 @@ static bool city_build_unit(struct player *pplayer, struct city *pcity)
     qDebug("%s %s tried to build %s, which is not available.",
            nation_rule_name(nation_of_city(pcity)), city_name_get(pcity),
            utype_rule_name(utype));
-    script_server_signal_emit("unit_cant_be_built", utype, pcity,
+    script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                               "unavailable");
     return city_exist(saved_city_id);
   }
@@ -2570,7 +2624,7 @@ static bool city_build_unit(struct player *pplayer, struct city *pcity)
                       "(city size: %d, unit population cost: %d)"),
                     city_link(pcity), utype_name_translation(utype),
                     city_size_get(pcity), pop_cost);
-      script_server_signal_emit("unit_cant_be_built", utype, pcity,
+      script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                                 "pop_cost");
       return city_exist(saved_city_id);
     }
@@ -3555,7 +3609,7 @@ static bool disband_city(struct city *pcity)
                   _("%s can't build %s yet, "
                     "as we can't disband our only city."),
                   city_link(pcity), utype_name_translation(utype));
-    script_server_signal_emit("unit_cant_be_built", utype, pcity,
+    script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                               "pop_cost");
     if (!city_exist(saved_id)) {
       // Script decided to remove even the last city
@@ -3585,7 +3639,7 @@ static bool disband_city(struct city *pcity)
                     utype_name_translation(utype));
     }
 
-    script_server_signal_emit("city_destroyed", pcity, pcity->owner,
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, pcity->owner,
                               nullptr);
 
     remove_city(pcity);
@@ -3886,11 +3940,11 @@ static bool do_city_migration(struct city *pcity_from, struct city *pcity_to)
                           true);
       sz_strlcpy(name_from, city_tile_link(pcity_from));
 
-      script_server_signal_emit("city_size_change", pcity_from, -1,
+      script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity_from, -1,
                                 "migration_from");
 
       if (city_exist(id)) {
-        script_server_signal_emit("city_destroyed", pcity_from,
+        script_server_signal_emit(SSIG_CITY_DESTROYED, pcity_from,
                                   pcity_from->owner, nullptr);
 
         if (city_exist(id)) {
@@ -3964,7 +4018,7 @@ static bool do_city_migration(struct city *pcity_from, struct city *pcity_to)
         auto_arrange_workers(pcity_to);
       }
       if (incr_success) {
-        script_server_signal_emit("city_size_change", pcity_to, 1,
+        script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity_to, 1,
                                   "migration_to");
       }
     }
@@ -4152,9 +4206,9 @@ static void apply_disaster(struct city *pcity, struct disaster_type *pdis)
     }
   }
 
-  script_server_signal_emit("disaster_occurred", pdis, pcity,
+  script_server_signal_emit(SSIG_DISASTER_OCCURRED, pdis, pcity,
                             had_internal_effect);
-  script_server_signal_emit("disaster", pdis, pcity);
+  script_server_signal_emit(SSIG_DISASTER, pdis, pcity);
 }
 
 /**
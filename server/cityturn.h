@@ -23,6 +23,8 @@ void city_refresh_for_player(struct player *pplayer); /* tax/govt changed */
 
 void city_refresh_queue_add(struct city *pcity);
 void city_refresh_queue_processing();
+void city_refresh_queue_freeze();
+void city_refresh_queue_thaw();
 
 void auto_arrange_workers(struct city *pcity); // will arrange the workers
 void apply_cmresult_to_city(struct city *pcity,
@@ -605,6 +605,7 @@ static struct command commands[] = {
         "lua unsafe-cmd <script line>\n"
         "lua file <script file>\n"
         "lua unsafe-file <script file>\n"
+        "lua signals\n"
         "lua <script line> (deprecated)"),
      N_("Evaluate a line of Freeciv21 script or a Freeciv21 script file in "
         "the current game."),
@@ -612,7 +613,9 @@ static struct command commands[] = {
         "ruleset. This instance doesn't restrict access to Lua functions "
         "that can be used to hack the computer running the Freeciv21 "
         "server. Access to it is therefore limited to the console and "
-        "connections with cmdlevel 'hack'"),
+        "connections with cmdlevel 'hack'.\n"
+        "'lua signals' shows how often each signal was emitted since the "
+        "scripts were loaded and how much time its callbacks took."),
      nullptr, CMD_ECHO_ADMINS, VCF_NONE, 0},
     {"kick", ALLOW_CTRL,
      // TRANS: translate text between <>
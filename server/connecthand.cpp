@@ -46,6 +46,7 @@
 #include "report.h"
 #include "ruleset.h"
 #include "server_connection.h"
+#include "session.h"
 #include "settings.h"
 #include "srv_main.h"
 #include "stdinhand.h"
@@ -129,6 +130,7 @@ void establish_new_connection(server_connection *pconn)
   struct packet_chat_msg connect_info;
   char hostname[512];
   bool delegation_error = false;
+  bool resumed;
   struct packet_set_topology topo_packet;
 
   // zero out the password
@@ -143,6 +145,8 @@ void establish_new_connection(server_connection *pconn)
   packet.conn_id = pconn->id;
   send_packet_server_join_reply(pconn, &packet);
   post_send_packet_server_join_reply(pconn, &packet);
+  // The client keeps its rulesets and map when resuming its session.
+  resumed = session_resume_accept(pconn);
 
   // "establish" the connection
   pconn->established = true;
@@ -179,14 +183,18 @@ void establish_new_connection(server_connection *pconn)
         qUtf8Printable(pconn->addr));
 
   conn_compression_freeze(pconn);
-  send_rulesets(dest);
-  send_server_setting_control(pconn);
+  if (!resumed) {
+    send_rulesets(dest);
+    send_server_setting_control(pconn);
+  }
   send_server_settings(dest);
   send_scenario_info(dest);
   send_scenario_description(dest);
   send_game_info(dest);
-  topo_packet.topology_id = wld.map.topology_id;
-  send_packet_set_topology(pconn, &topo_packet);
+  if (!resumed) {
+    topo_packet.topology_id = wld.map.topology_id;
+    send_packet_set_topology(pconn, &topo_packet);
+  }
 
   // Do we have a player that a delegate is currently controlling?
   if ((pplayer = player_by_user_delegated(pconn->username))) {
@@ -713,7 +721,9 @@ static bool connection_attach_real(server_connection *pconn,
 
     case S_S_RUNNING:
       conn_compression_freeze(pconn);
-      send_all_info(pconn->self);
+      if (!session_resume(pconn)) {
+        send_all_info(pconn->self);
+      }
       if (game.info.is_edit_mode && can_conn_edit(pconn)) {
         edithand_send_initial_packets(pconn->self);
       }
@@ -728,7 +738,9 @@ static bool connection_attach_real(server_connection *pconn,
 
     case S_S_OVER:
       conn_compression_freeze(pconn);
-      send_all_info(pconn->self);
+      if (!session_resume(pconn)) {
+        send_all_info(pconn->self);
+      }
       if (game.info.is_edit_mode && can_conn_edit(pconn)) {
         edithand_send_initial_packets(pconn->self);
       }
@@ -549,8 +549,8 @@ void handle_diplomacy_accept_treaty_req(struct player *pplayer,
 
         if (transfer_city(pdest, pcity, -1, true, true, false,
                           !is_barbarian(pdest))) {
-          script_server_signal_emit("city_transferred", pcity, pgiver, pdest,
-                                    "trade");
+          script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pgiver,
+                                    pdest, "trade");
         }
         break;
       }
@@ -1130,7 +1130,7 @@ bool diplomat_incite(struct player *pplayer, struct unit *pdiplomat,
      are within one square of the city) to the new owner. */
   if (transfer_city(pplayer, pcity, 1, true, true, false,
                     !is_barbarian(pplayer))) {
-    script_server_signal_emit("city_transferred", pcity, cplayer, pplayer,
+    script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, cplayer, pplayer,
                               "incited");
   }
 
@@ -42,6 +42,7 @@
 #include "plrhand.h"
 #include "sanitycheck.h"
 #include "server_connection.h"
+#include "session.h"
 #include "techtools.h"
 #include "unittools.h"
 
@@ -1225,6 +1226,7 @@ void handle_edit_player_vision(server_connection *pc, int plr_no, int tile,
        * not give it vision. */
       unit_list_iterate(ptile->units, punit)
       {
+        session_unit_changed(punit);
         conn_list_iterate(pplayer->connections, pconn)
         {
           dsend_packet_unit_remove(pconn, punit->id);
@@ -1251,6 +1253,7 @@ void handle_edit_player_vision(server_connection *pc, int plr_no, int tile,
  */
 void handle_edit_recalculate_borders(server_connection *pc)
 {
+  map_borders_invalidate();
   map_calculate_borders();
 }
 
@@ -970,7 +970,7 @@ bool map_generate_fair_islands()
   {
     tile_set_terrain(ptile, deepest_ocean);
     tile_set_continent(ptile, 0);
-    BV_CLR_ALL(ptile->extras);
+    tile_set_extras(ptile, tile_extras_null());
     tile_set_owner(ptile, nullptr, nullptr);
     ptile->extras_owner = nullptr;
   }
@@ -1236,7 +1236,7 @@ bool map_generate_fair_islands()
 
     fc_assert(pftile->pterrain != nullptr);
     tile_set_terrain(ptile, pftile->pterrain);
-    ptile->extras = pftile->extras;
+    tile_set_extras(ptile, &pftile->extras);
     tile_set_resource(ptile, pftile->presource);
     if (pftile->flags & FTF_STARTPOS) {
       struct startpos *psp = map_startpos_new(ptile);
@@ -59,16 +59,18 @@ static float hmap_pole_factor(struct tile *ptile)
  */
 void normalize_hmap_poles()
 {
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
-      hmap(ptile) *= hmap_pole_factor(ptile);
-    } else if (near_singularity(ptile)) {
-      // Near map edge but not near pole.
-      hmap(ptile) = 0;
+  native_rows_parallel([](int nat_y) {
+    for (int nat_x = 0; nat_x < wld.map.xsize; nat_x++) {
+      struct tile *ptile = native_pos_to_tile(&(wld.map), nat_x, nat_y);
+
+      if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
+        hmap(ptile) *= hmap_pole_factor(ptile);
+      } else if (near_singularity(ptile)) {
+        // Near map edge but not near pole.
+        hmap(ptile) = 0;
+      }
     }
-  }
-  whole_map_iterate_end;
+  });
 }
 
 /**
@@ -77,20 +79,22 @@ void normalize_hmap_poles()
  */
 void renormalize_hmap_poles()
 {
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    if (hmap(ptile) == 0) {
-      // Nothing left to restore.
-    } else if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
-      float factor = hmap_pole_factor(ptile);
-
-      if (factor > 0) {
-        // Invert the previously applied function
-        hmap(ptile) /= factor;
+  native_rows_parallel([](int nat_y) {
+    for (int nat_x = 0; nat_x < wld.map.xsize; nat_x++) {
+      struct tile *ptile = native_pos_to_tile(&(wld.map), nat_x, nat_y);
+
+      if (hmap(ptile) == 0) {
+        // Nothing left to restore.
+      } else if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
+        float factor = hmap_pole_factor(ptile);
+
+        if (factor > 0) {
+          // Invert the previously applied function
+          hmap(ptile) /= factor;
+        }
       }
     }
-  }
-  whole_map_iterate_end;
+  });
 }
 
 /**
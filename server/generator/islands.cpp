@@ -280,7 +280,7 @@ static void initworld(struct gen234_state *pstate)
     tile_set_terrain(ptile, deepest_ocean);
     tile_set_continent(ptile, 0);
     map_set_placed(ptile); // not a land tile
-    BV_CLR_ALL(ptile->extras);
+    tile_set_extras(ptile, tile_extras_null());
     tile_set_owner(ptile, nullptr, nullptr);
     ptile->extras_owner = nullptr;
   }
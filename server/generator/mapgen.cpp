@@ -22,6 +22,7 @@
 #include "log.h"
 #include "rand.h"
 #include "shared.h"
+#include "timing.h"
 
 // common
 #include "game.h"
@@ -1216,6 +1217,18 @@ static void print_mapgen_map()
   terrain_type_iterate_end;
 }
 
+/**
+   Log the time the map generator spent in the stage that just finished,
+   and restart the timer for the next one.
+ */
+static void mapgen_stage_done(civtimer *timer, const char *stage)
+{
+  qCDebug(timers_category, "Map generator: %s in %.3f seconds.", stage,
+          timer_read_seconds(timer));
+  timer_clear(timer);
+  timer_start(timer);
+}
+
 /**
    See stdinhand.c for information on map generation methods.
 
@@ -1232,6 +1245,9 @@ static void print_mapgen_map()
 bool map_generate(bool autosize, struct unit_type *initial_unit)
 {
   auto rstate = fc_rand_state();
+  civtimer *stage_timer = timer_new(TIMER_USER, TIMER_DEBUG);
+
+  timer_start(stage_timer);
 
   if (wld.map.server.seed_setting == 0) {
     // Create a random map seed.
@@ -1260,6 +1276,7 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
 
     // create a temperature map
     create_tmap(false);
+    mapgen_stage_done(stage_timer, "topology and temperature");
 
     if (MAPGEN_FAIR == wld.map.server.generator
         && !map_generate_fair_islands()) {
@@ -1282,6 +1299,7 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
     if (MAPGEN_FRACTURE == wld.map.server.generator) {
       make_fracture_hmap();
     }
+    mapgen_stage_done(stage_timer, "height map");
 
     // if hmap only generator make anything else
     if (MAPGEN_RANDOM == wld.map.server.generator
@@ -1290,6 +1308,7 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
       make_land();
       delete[] height_map;
       height_map = nullptr;
+      mapgen_stage_done(stage_timer, "land");
     }
     if (!wld.map.server.tinyisles) {
       remove_tiny_islands();
@@ -1302,6 +1321,7 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
 
     // Turn small oceans into lakes.
     regenerate_lakes();
+    mapgen_stage_done(stage_timer, "water and continents");
   } else {
     assign_continent_numbers();
   }
@@ -1319,6 +1339,7 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
   if (!wld.map.server.have_huts) {
     make_huts(wld.map.server.huts * map_num_tiles() / 1000);
   }
+  mapgen_stage_done(stage_timer, "resources and huts");
 
   // restore previous random state:
   fc_rand_set_state(rstate);
@@ -1390,11 +1411,15 @@ bool map_generate(bool autosize, struct unit_type *initial_unit)
       default:
         qCritical(_("The server couldn't allocate starting positions."));
         destroy_tmap();
+        timer_destroy(stage_timer);
         return false;
       }
     }
   }
 
+  mapgen_stage_done(stage_timer, "start positions");
+  timer_destroy(stage_timer);
+
   // destroy temperature map
   destroy_tmap();
 
@@ -8,6 +8,10 @@ _   ._       Copyright (c) 1996-2021 Freeciv21 and Freeciv contributors.
   :X:      received a copy of the GNU General Public License along with
   :X:              Freeciv21. If not, see https://www.gnu.org/licenses/.
  */
+// Qt
+#include <QThread>
+#include <QThreadPool>
+
 // utility
 #include "fcintl.h"
 #include "log.h"
@@ -157,6 +161,78 @@ void adjust_int_map_filtered(int *int_map, int int_map_max, void *data,
   }
 }
 
+/**
+   Call kernel(nat_y) once for every native row of the map. The rows are
+   spread over the available cores, so the kernel must only write data
+   belonging to its own row and must not use the random number generator.
+ */
+void native_rows_parallel(const std::function<void(int nat_y)> &kernel)
+{
+  const int rows = wld.map.ysize;
+  // A few chunks per core, to even out rows of uneven cost.
+  const int chunks = MIN(rows, 4 * QThread::idealThreadCount());
+  QThreadPool pool;
+
+  if (chunks <= 1) {
+    for (int nat_y = 0; nat_y < rows; nat_y++) {
+      kernel(nat_y);
+    }
+    return;
+  }
+
+  for (int i = 0; i < chunks; i++) {
+    const int first = rows * i / chunks;
+    const int last = rows * (i + 1) / chunks;
+
+    pool.start([&kernel, first, last] {
+      for (int nat_y = first; nat_y < last; nat_y++) {
+        kernel(nat_y);
+      }
+    });
+  }
+  pool.waitForDone();
+}
+
+/**
+   One pass of smooth_int_map() over the native row nat_y, along the X or
+   the Y native axis. Works the same as axis_iterate() on plain indices.
+ */
+static void smooth_int_map_row(const int *source_map, int *target_map,
+                               int nat_y, bool is_x_axis,
+                               const float *weight, bool zeroes_at_edges)
+{
+  const int xsize = wld.map.xsize, ysize = wld.map.ysize;
+  const bool wrapx = current_topo_has_flag(TF_WRAPX);
+  const bool wrapy = current_topo_has_flag(TF_WRAPY);
+
+  for (int nat_x = 0; nat_x < xsize; nat_x++) {
+    float N = 0, D = 0;
+
+    for (int i = -2; i <= 2; i++) {
+      int x = nat_x + (is_x_axis ? i : 0);
+      int y = nat_y + (is_x_axis ? 0 : i);
+
+      if (wrapx) {
+        x = FC_WRAP(x, xsize);
+      } else if (x < 0 || x >= xsize) {
+        continue;
+      }
+      if (wrapy) {
+        y = FC_WRAP(y, ysize);
+      } else if (y < 0 || y >= ysize) {
+        continue;
+      }
+
+      D += weight[i + 2];
+      N += weight[i + 2] * source_map[native_pos_to_index_nocheck(x, y)];
+    }
+    if (zeroes_at_edges) {
+      D = 1;
+    }
+    target_map[native_pos_to_index_nocheck(nat_x, nat_y)] = N / D;
+  }
+}
+
 /**
    Apply a Gaussian diffusion filter on the map. The size of the map is
    MAP_INDEX_SIZE and the map is indexed by native_pos_to_index function.
@@ -179,22 +255,10 @@ void smooth_int_map(int *int_map, bool zeroes_at_edges)
   source_map = int_map;
 
   do {
-    whole_map_iterate(&(wld.map), ptile)
-    {
-      float N = 0, D = 0;
-
-      axis_iterate(&(wld.map), ptile, pnear, i, 2, axe)
-      {
-        D += weight[i + 2];
-        N += weight[i + 2] * source_map[tile_index(pnear)];
-      }
-      axis_iterate_end;
-      if (zeroes_at_edges) {
-        D = 1;
-      }
-      target_map[tile_index(ptile)] = N / D;
-    }
-    whole_map_iterate_end;
+    native_rows_parallel([=](int nat_y) {
+      smooth_int_map_row(source_map, target_map, nat_y, axe, weight,
+                         zeroes_at_edges);
+    });
 
     if (MAP_IS_ISOMETRIC) {
       weight = weight_isometric;
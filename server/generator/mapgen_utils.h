@@ -10,6 +10,8 @@
 **************************************************************************/
 #pragma once
 
+#include <functional>
+
 #define MG_UNUSED mapgen_terrain_property_invalid()
 
 void generator_free();
@@ -104,6 +106,8 @@ void adjust_int_map_filtered(int *int_map, int int_map_max, void *data,
       (bool (*)(const struct tile *ptile, const void *data)) nullptr)
 void smooth_int_map(int *int_map, bool zeroes_at_edges);
 
+void native_rows_parallel(const std::function<void(int nat_y)> &kernel);
+
 // placed_map tool
 void create_placed_map();
 void destroy_placed_map();
@@ -119,28 +119,31 @@ void create_tmap(bool real)
   fc_assert_ret(nullptr == temperature_map);
 
   temperature_map = new int[MAP_INDEX_SIZE];
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    // the base temperature is equal to base map_colatitude
-    int t = map_colatitude(ptile);
-
-    if (!real) {
-      tmap(ptile) = t;
-    } else {
-      // high land can be 30% cooler
-      float height = -0.3 * MAX(0, hmap(ptile) - hmap_shore_level)
-                     / (hmap_max_level - hmap_shore_level);
-      // near ocean temperature can be 15% more "temperate"
-      float temperate =
-          (0.15 * (wld.map.server.temperature / 100 - t / MAX_COLATITUDE) * 2
-           * MIN(50,
-                 count_terrain_class_near_tile(ptile, false, true, TC_OCEAN))
-           / 100);
-
-      tmap(ptile) = t * (1.0 + temperate) * (1.0 + height);
+  native_rows_parallel([real](int nat_y) {
+    for (int nat_x = 0; nat_x < wld.map.xsize; nat_x++) {
+      const struct tile *ptile =
+          native_pos_to_tile(&(wld.map), nat_x, nat_y);
+      // the base temperature is equal to base map_colatitude
+      int t = map_colatitude(ptile);
+
+      if (!real) {
+        tmap(ptile) = t;
+      } else {
+        // high land can be 30% cooler
+        float height = -0.3 * MAX(0, hmap(ptile) - hmap_shore_level)
+                       / (hmap_max_level - hmap_shore_level);
+        // near ocean temperature can be 15% more "temperate"
+        float temperate =
+            (0.15 * (wld.map.server.temperature / 100 - t / MAX_COLATITUDE)
+             * 2
+             * MIN(50, count_terrain_class_near_tile(ptile, false, true,
+                                                     TC_OCEAN))
+             / 100);
+
+        tmap(ptile) = t * (1.0 + temperate) * (1.0 + height);
+      }
     }
-  }
-  whole_map_iterate_end;
+  });
   // adjust to get well sizes frequencies
   /* Notice: if colatitude is loaded from a scenario never call adjust.
              Scenario may have an odd colatitude distribution and adjust will
@@ -13,12 +13,17 @@
 
 #include <QBitArray>
 
+// std
+#include <array>
+#include <vector>
+
 // utility
 #include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
 #include "rand.h"
 #include "support.h"
+#include "timing.h"
 
 // common
 #include "ai.h"
@@ -42,6 +47,7 @@
 #include "plrhand.h"
 #include "sanitycheck.h"
 #include "sernet.h"
+#include "session.h"
 #include "srv_main.h"
 #include "unittools.h"
 
@@ -55,6 +61,20 @@
 // Suppress send_tile_info() during game_load()
 static bool send_tile_suppressed = false;
 
+/* For every tile and vision layer, the players having a non-zero seen
+ * count there. Mirrors player_tile::seen_count so that the broadcast code
+ * doesn't have to walk every player's private map. */
+static std::vector<std::array<bv_player, V_COUNT>> tile_seen_by;
+
+/* Tiles whose border related state (owner, extras, knowledge, strength of
+ * a nearby source...) changed since the last map_calculate_borders(). Only
+ * the border sources having such a tile in their radius get reclaimed. */
+static QBitArray border_dirty_tiles;
+static bool border_all_dirty = true;
+static bool border_pass_running = false;
+// Claim_Ocean and Claim_Ocean_Limited techs known at the last pass.
+static int border_ocean_techs[MAX_NUM_PLAYER_SLOTS][2];
+
 static void player_tile_init(struct tile *ptile, struct player *pplayer);
 static void player_tile_free(struct tile *ptile, struct player *pplayer);
 static void give_tile_info_from_player_to_player(struct player *pfrom,
@@ -74,9 +94,15 @@ static inline int map_get_seen(const struct player *pplayer,
 static inline int map_get_own_seen(const struct player *pplayer,
                                    const struct tile *ptile,
                                    enum vision_layer vlayer);
+static inline void tile_seen_by_update(const struct tile *ptile,
+                                       const struct player *pplayer,
+                                       enum vision_layer vlayer,
+                                       int seen_count);
+static int bitarray_next_set(const QBitArray &bits, int from);
 
 static bool is_claimable_ocean(struct tile *ptile, struct tile *source,
                                struct player *pplayer);
+static inline void border_tile_dirty(const struct tile *ptile);
 
 /**
    Used only in global_warming() and nuclear_winter() below.
@@ -368,11 +394,13 @@ void give_map_from_player_to_player(struct player *pfrom,
 {
   buffer_shared_vision(pdest);
 
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+  /* Only the tiles pfrom knows can be given; this is also true for the
+   * players pdest shares its vision with. */
+  const QBitArray known = *pfrom->tile_known;
+  for (int i = bitarray_next_set(known, 0); i >= 0;
+       i = bitarray_next_set(known, i + 1)) {
+    give_tile_info_from_player_to_player(pfrom, pdest, wld.map.tiles + i);
   }
-  whole_map_iterate_end;
 
   unbuffer_shared_vision(pdest);
   city_thaw_workers_queue();
@@ -387,13 +415,15 @@ void give_seamap_from_player_to_player(struct player *pfrom,
 {
   buffer_shared_vision(pdest);
 
-  whole_map_iterate(&(wld.map), ptile)
-  {
+  const QBitArray known = *pfrom->tile_known;
+  for (int i = bitarray_next_set(known, 0); i >= 0;
+       i = bitarray_next_set(known, i + 1)) {
+    struct tile *ptile = wld.map.tiles + i;
+
     if (is_ocean_tile(ptile)) {
       give_tile_info_from_player_to_player(pfrom, pdest, ptile);
     }
   }
-  whole_map_iterate_end;
 
   unbuffer_shared_vision(pdest);
   city_thaw_workers_queue();
@@ -495,6 +525,8 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     return;
   }
 
+  session_tile_changed(ptile);
+
   if (!dest) {
     dest = game.est_connections;
   }
@@ -722,14 +754,16 @@ void map_set_border_vision(struct player *pplayer, const bool is_enabled)
   // Set the new border seer value.
   pplayer->server.border_vision = is_enabled;
 
-  whole_map_iterate(&(wld.map), ptile)
+  const int owner = player_number(pplayer);
+  whole_map_index_iterate(&(wld.map), i)
   {
-    if (pplayer == ptile->owner) {
+    if (wld.map.hot->owner[i] == owner) {
       // The tile is within the player's borders.
-      shared_vision_change_seen(pplayer, ptile, radius_sq, true);
+      shared_vision_change_seen(pplayer, wld.map.tiles + i, radius_sq,
+                                true);
     }
   }
-  whole_map_iterate_end;
+  whole_map_index_iterate_end;
 }
 
 /**
@@ -894,7 +928,7 @@ bool map_is_known_and_seen(const struct tile *ptile,
                            enum vision_layer vlayer)
 {
   return (map_is_known(ptile, pplayer)
-          && 0 < map_get_seen(pplayer, ptile, vlayer));
+          && pplayer->server.tile_seen[vlayer]->at(tile_index(ptile)));
 }
 
 /**
@@ -911,6 +945,69 @@ static inline int map_get_seen(const struct player *pplayer,
   return map_get_player_tile(ptile, pplayer)->seen_count[vlayer];
 }
 
+/**
+   Records in tile_seen_by whether pplayer sees the layer 'vlayer' of
+   'ptile', given the new seen count of the player there.
+ */
+static inline void tile_seen_by_update(const struct tile *ptile,
+                                       const struct player *pplayer,
+                                       enum vision_layer vlayer,
+                                       int seen_count)
+{
+  bv_player &seen_by = tile_seen_by[tile_index(ptile)][vlayer];
+
+  if (0 < seen_count) {
+    BV_SET(seen_by, player_index(pplayer));
+  } else {
+    BV_CLR(seen_by, player_index(pplayer));
+  }
+  pplayer->server.tile_seen[vlayer]->setBit(tile_index(ptile),
+                                            0 < seen_count);
+}
+
+/**
+   Returns the index of the first bit set in bits at or after from, or -1
+   if there is none. Clear bytes are skipped at once, so walking the set
+   bits of a sparse map-sized bit array is cheap.
+ */
+static int bitarray_next_set(const QBitArray &bits, int from)
+{
+  const int size = bits.size();
+  const auto *data = reinterpret_cast<const unsigned char *>(bits.bits());
+
+  while (from < size) {
+    unsigned char byte = data[from >> 3] >> (from & 7);
+
+    if (byte == 0) {
+      from = (from | 7) + 1;
+      continue;
+    }
+    while (!(byte & 1)) {
+      byte >>= 1;
+      from++;
+    }
+    return from < size ? from : -1;
+  }
+
+  return -1;
+}
+
+/**
+   Returns the set of players seeing the layer 'vlayer' of 'ptile', i.e.
+   the players for which map_get_seen() is non-zero. Whether they also
+   know the tile must be checked separately. Returns nullptr when the
+   private maps of the players are not allocated yet.
+ */
+const bv_player *map_tile_seen_by(const struct tile *ptile,
+                                  enum vision_layer vlayer)
+{
+  if (tile_index(ptile) >= (int) tile_seen_by.size()) {
+    return nullptr;
+  }
+
+  return &tile_seen_by[tile_index(ptile)][vlayer];
+}
+
 /**
    This function changes the seen state of one player for all vision layers
    of a tile. It reveals the tiles if needed and controls the fog of war.
@@ -985,6 +1082,7 @@ void map_change_seen(struct player *pplayer, struct tile *ptile,
     // Avoid underflow.
     fc_assert(0 <= change[v] || -change[v] <= plrtile->seen_count[v]);
     plrtile->seen_count[v] += change[v];
+    tile_seen_by_update(ptile, pplayer, v, plrtile->seen_count[v]);
   }
   vision_layer_iterate_end;
 
@@ -1110,7 +1208,12 @@ static void map_change_own_seen(struct player *pplayer, struct tile *ptile,
 {
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
 
-  vision_layer_iterate(v) { plrtile->own_seen[v] += change[v]; }
+  vision_layer_iterate(v)
+  {
+    plrtile->own_seen[v] += change[v];
+    pplayer->server.tile_own_seen[v]->setBit(tile_index(ptile),
+                                             0 < plrtile->own_seen[v]);
+  }
   vision_layer_iterate_end;
 }
 
@@ -1131,6 +1234,7 @@ void change_playertile_site(struct player_tile *ptile,
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
   pplayer->tile_known->setBit(tile_index(ptile));
+  border_tile_dirty(ptile);
 }
 
 /**
@@ -1177,6 +1281,25 @@ void player_map_init(struct player *pplayer)
   delete[] pplayer->server.private_map;
   pplayer->server.private_map = new player_tile[MAP_INDEX_SIZE];
 
+  // The player may now know a different set of tiles.
+  map_borders_invalidate();
+
+  if (tile_seen_by.size() != (size_t) MAP_INDEX_SIZE) {
+    // The map was (re)allocated, every private map will be reset.
+    tile_seen_by.assign(MAP_INDEX_SIZE, {});
+  }
+
+  vision_layer_iterate(v)
+  {
+    if (pplayer->server.tile_seen[v] == nullptr) {
+      pplayer->server.tile_seen[v] = new QBitArray();
+      pplayer->server.tile_own_seen[v] = new QBitArray();
+    }
+    pplayer->server.tile_seen[v]->fill(false, MAP_INDEX_SIZE);
+    pplayer->server.tile_own_seen[v]->fill(false, MAP_INDEX_SIZE);
+  }
+  vision_layer_iterate_end;
+
   whole_map_iterate(&(wld.map), ptile) { player_tile_init(ptile, pplayer); }
   whole_map_iterate_end;
 
@@ -1198,6 +1321,15 @@ void player_map_free(struct player *pplayer)
   delete[] pplayer->server.private_map;
   pplayer->server.private_map = nullptr;
   pplayer->tile_known->clear();
+
+  vision_layer_iterate(v)
+  {
+    delete pplayer->server.tile_seen[v];
+    pplayer->server.tile_seen[v] = nullptr;
+    delete pplayer->server.tile_own_seen[v];
+    pplayer->server.tile_own_seen[v] = nullptr;
+  }
+  vision_layer_iterate_end;
 }
 
 /**
@@ -1209,6 +1341,7 @@ void remove_player_from_maps(struct player *pplayer)
 {
   // only after removing borders!
   conn_list_do_buffer(game.est_connections);
+  map_borders_invalidate();
   whole_map_iterate(&(wld.map), ptile)
   {
     /* Clear all players' knowledge about the removed player, and free
@@ -1299,6 +1432,14 @@ static void player_tile_init(struct tile *ptile, struct player *pplayer)
   plrtile->seen_count[V_INVIS] = 0;
   plrtile->seen_count[V_SUBSURFACE] = 0;
   memcpy(plrtile->own_seen, plrtile->seen_count, sizeof(v_radius_t));
+
+  vision_layer_iterate(v)
+  {
+    tile_seen_by_update(ptile, pplayer, v, plrtile->seen_count[v]);
+    pplayer->server.tile_own_seen[v]->setBit(tile_index(ptile),
+                                             0 < plrtile->own_seen[v]);
+  }
+  vision_layer_iterate_end;
 }
 
 /**
@@ -1307,6 +1448,14 @@ static void player_tile_init(struct tile *ptile, struct player *pplayer)
 static void player_tile_free(struct tile *ptile, struct player *pplayer)
 {
   map_get_player_tile(ptile, pplayer)->site = nullptr;
+
+  if (tile_index(ptile) < (int) tile_seen_by.size()) {
+    vision_layer_iterate(v)
+    {
+      tile_seen_by_update(ptile, pplayer, v, 0);
+    }
+    vision_layer_iterate_end;
+  }
 }
 
 /**
@@ -1396,6 +1545,8 @@ void update_tile_knowledge(struct tile *ptile)
     return;
   }
 
+  border_tile_dirty(ptile);
+
   // Players
   players_iterate(pplayer)
   {
@@ -1487,11 +1638,17 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
 static void really_give_map_from_player_to_player(struct player *pfrom,
                                                   struct player *pdest)
 {
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    really_give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+  /* The tiles pfrom knows and pdest doesn't see, i.e. those that pass the
+   * first checks of really_give_tile_info_from_player_to_player(). */
+  const QBitArray tiles =
+      *pfrom->tile_known
+      & ~(*pdest->tile_known & *pdest->server.tile_seen[V_MAIN]);
+
+  for (int i = bitarray_next_set(tiles, 0); i >= 0;
+       i = bitarray_next_set(tiles, i + 1)) {
+    really_give_tile_info_from_player_to_player(pfrom, pdest,
+                                                wld.map.tiles + i);
   }
-  whole_map_iterate_end;
 
   city_thaw_workers_queue();
   sync_cities();
@@ -1566,6 +1723,8 @@ static void create_vision_dependencies()
 void give_shared_vision(struct player *pfrom, struct player *pto)
 {
   bv_player save_vision[MAX_NUM_PLAYER_SLOTS];
+  civtimer *timer;
+
   if (pfrom == pto) {
     return;
   }
@@ -1582,6 +1741,9 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
   }
   players_iterate_end;
 
+  timer = timer_new(TIMER_CPU, TIMER_DEBUG);
+  timer_start(timer);
+
   BV_SET(pfrom->gives_shared_vision, player_index(pto));
   create_vision_dependencies();
   log_debug("giving shared vision from %s to %s", player_name(pfrom),
@@ -1597,19 +1759,20 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
                        player_index(pplayer2))) {
         log_debug("really giving shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile)
-        {
+        const QBitArray seen = *pplayer->server.tile_own_seen[V_MAIN]
+                               | *pplayer->server.tile_own_seen[V_INVIS];
+
+        for (int i = bitarray_next_set(seen, 0); i >= 0;
+             i = bitarray_next_set(seen, i + 1)) {
+          struct tile *ptile = wld.map.tiles + i;
           const v_radius_t change =
               V_RADIUS(map_get_own_seen(pplayer, ptile, V_MAIN),
                        map_get_own_seen(pplayer, ptile, V_INVIS),
                        map_get_own_seen(pplayer, ptile, V_SUBSURFACE));
 
-          if (0 < change[V_MAIN] || 0 < change[V_INVIS]) {
-            map_change_seen(pplayer2, ptile, change,
-                            map_is_known(ptile, pplayer));
-          }
+          map_change_seen(pplayer2, ptile, change,
+                          map_is_known(ptile, pplayer));
         }
-        whole_map_iterate_end;
 
         /* squares that are not seen, but which pfrom may have more recent
            knowledge of */
@@ -1621,6 +1784,12 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
   }
   players_iterate_end;
 
+  timer_stop(timer);
+  qCDebug(timers_category,
+          "Shared vision from %s to %s given in %.3f seconds.",
+          player_name(pfrom), player_name(pto), timer_read_seconds(timer));
+  timer_destroy(timer);
+
   if (S_S_RUNNING == server_state()) {
     send_player_info_c(pfrom, nullptr);
   }
@@ -1663,18 +1832,19 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
                       player_index(pplayer2))) {
         log_debug("really removing shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile)
-        {
+        const QBitArray seen = *pplayer->server.tile_own_seen[V_MAIN]
+                               | *pplayer->server.tile_own_seen[V_INVIS];
+
+        for (int i = bitarray_next_set(seen, 0); i >= 0;
+             i = bitarray_next_set(seen, i + 1)) {
+          struct tile *ptile = wld.map.tiles + i;
           const v_radius_t change =
               V_RADIUS(-map_get_own_seen(pplayer, ptile, V_MAIN),
                        -map_get_own_seen(pplayer, ptile, V_INVIS),
                        -map_get_own_seen(pplayer, ptile, V_SUBSURFACE));
 
-          if (0 > change[V_MAIN] || 0 > change[V_INVIS]) {
-            map_change_seen(pplayer2, ptile, change, false);
-          }
+          map_change_seen(pplayer2, ptile, change, false);
         }
-        whole_map_iterate_end;
       }
     }
     players_iterate_end;
@@ -1937,6 +2107,7 @@ void check_terrain_change(struct tile *ptile, struct terrain *oldter)
 
   if (need_to_reassign_continents(oldter, newter)) {
     assign_continent_numbers();
+    map_borders_invalidate();
     send_all_known_tiles(nullptr);
   }
 
@@ -2114,6 +2285,8 @@ void map_clear_border(struct tile *ptile)
 {
   int radius_sq = tile_border_source_radius_sq(ptile);
 
+  map_borders_dirty(ptile, radius_sq);
+
   circle_dxyr_iterate(&(wld.map), ptile, radius_sq, dtile, dx, dy, dr)
   {
     struct tile *claimer = tile_claimer(dtile);
@@ -2127,17 +2300,20 @@ void map_clear_border(struct tile *ptile)
 
 /**
    Update borders for this source. Changes the radius without temporary
-   clearing.
+   clearing. Call this whenever the size of the source city changes: its
+   strength changes even when its radius doesn't.
  */
 void map_update_border(struct tile *ptile, struct player *owner,
                        int old_radius_sq, int new_radius_sq)
 {
-  if (old_radius_sq == new_radius_sq) {
-    // No change
+  if (BORDERS_DISABLED == game.info.borders) {
     return;
   }
 
-  if (BORDERS_DISABLED == game.info.borders) {
+  map_borders_dirty(ptile, MAX(old_radius_sq, new_radius_sq));
+
+  if (old_radius_sq == new_radius_sq) {
+    // No change
     return;
   }
 
@@ -2182,6 +2358,8 @@ void map_claim_border(struct tile *ptile, struct player *owner,
     radius_sq = tile_border_source_radius_sq(ptile);
   }
 
+  map_borders_dirty(ptile, radius_sq);
+
   circle_dxyr_iterate(&(wld.map), ptile, radius_sq, dtile, dx, dy, dr)
   {
     struct tile *dclaimer = tile_claimer(dtile);
@@ -2249,11 +2427,84 @@ void map_claim_border(struct tile *ptile, struct player *owner,
   circle_dxyr_iterate_end;
 }
 
+/**
+   Mark a single tile as needing its border claims to be reconsidered.
+ */
+static inline void border_tile_dirty(const struct tile *ptile)
+{
+  if (tile_index(ptile) < border_dirty_tiles.size()) {
+    border_dirty_tiles.setBit(tile_index(ptile));
+  }
+}
+
+/**
+   Mark the tiles within radius_sq of ptile as needing their border claims
+   to be reconsidered. Call this when a border source changes in a way
+   that may let its neighbours claim or lose tiles around it.
+ */
+void map_borders_dirty(const struct tile *ptile, int radius_sq)
+{
+  if (border_pass_running || border_all_dirty) {
+    // Changes made by the pass itself are marked tile by tile.
+    return;
+  }
+
+  circle_iterate(&(wld.map), ptile, radius_sq, dtile)
+  {
+    border_tile_dirty(dtile);
+  }
+  circle_iterate_end;
+}
+
+/**
+   Make the next map_calculate_borders() reclaim every border source.
+ */
+void map_borders_invalidate() { border_all_dirty = true; }
+
+/**
+   Returns whether the border source at ptile may claim or give up tiles
+   since the last time all the sources were considered.
+ */
+static bool border_source_dirty(struct tile *ptile, const QBitArray &dirty)
+{
+  const struct player *owner = tile_owner(ptile);
+
+  if (owner != nullptr
+      && (border_ocean_techs[player_index(owner)][0]
+              != num_known_tech_with_flag(owner, TF_CLAIM_OCEAN)
+          || border_ocean_techs[player_index(owner)][1]
+                 != num_known_tech_with_flag(owner,
+                                             TF_CLAIM_OCEAN_LIMITED))) {
+    return true;
+  }
+
+  circle_iterate(&(wld.map), ptile, tile_border_source_radius_sq(ptile),
+                 dtile)
+  {
+    // Also look at the changes made earlier in this pass.
+    if (dirty.testBit(tile_index(dtile))
+        || border_dirty_tiles.testBit(tile_index(dtile))) {
+      return true;
+    }
+  }
+  circle_iterate_end;
+
+  return false;
+}
+
 /**
    Update borders for all sources. Call this on turn end.
+
+   Only the sources that have a changed tile within their radius are
+   reclaimed, the others would end up claiming exactly the same tiles.
+   Use map_borders_invalidate() first to force a full recalculation.
  */
 void map_calculate_borders()
 {
+  QBitArray dirty;
+  bool all_dirty;
+  int sources = 0, reclaimed = 0;
+
   if (BORDERS_DISABLED == game.info.borders) {
     return;
   }
@@ -2265,14 +2516,44 @@ void map_calculate_borders()
 
   qDebug("map_calculate_borders()");
 
+  if (border_dirty_tiles.size() != MAP_INDEX_SIZE) {
+    border_dirty_tiles.resize(MAP_INDEX_SIZE);
+    border_all_dirty = true;
+  }
+
+  // Changes made from now on are for the next pass to look at.
+  dirty = border_dirty_tiles;
+  all_dirty = border_all_dirty;
+  border_dirty_tiles.fill(false);
+  border_all_dirty = false;
+  border_pass_running = true;
+
   whole_map_iterate(&(wld.map), ptile)
   {
     if (is_border_source(ptile)) {
-      map_claim_border(ptile, ptile->owner, -1);
+      sources++;
+      if (all_dirty || border_source_dirty(ptile, dirty)) {
+        map_claim_border(ptile, ptile->owner, -1);
+        reclaimed++;
+      }
     }
   }
   whole_map_iterate_end;
 
+  border_pass_running = false;
+
+  players_iterate(pplayer)
+  {
+    border_ocean_techs[player_index(pplayer)][0] =
+        num_known_tech_with_flag(pplayer, TF_CLAIM_OCEAN);
+    border_ocean_techs[player_index(pplayer)][1] =
+        num_known_tech_with_flag(pplayer, TF_CLAIM_OCEAN_LIMITED);
+  }
+  players_iterate_end;
+
+  log_debug("map_calculate_borders(): reclaimed %d of %d sources.",
+            reclaimed, sources);
+
   qDebug("map_calculate_borders() workers");
   city_thaw_workers_queue();
   city_refresh_queue_processing();
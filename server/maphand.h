@@ -77,6 +77,8 @@ bool map_is_known_and_seen(const struct tile *ptile,
                            const struct player *pplayer,
                            enum vision_layer vlayer);
 bool map_is_known(const struct tile *ptile, const struct player *pplayer);
+const bv_player *map_tile_seen_by(const struct tile *ptile,
+                                  enum vision_layer vlayer);
 void map_set_known(struct tile *ptile, struct player *pplayer);
 void map_clear_known(struct tile *ptile, struct player *pplayer);
 void map_know_and_see_all(struct player *pplayer);
@@ -108,6 +110,8 @@ void enable_fog_of_war_player(struct player *pplayer);
 void disable_fog_of_war_player(struct player *pplayer);
 
 void map_calculate_borders();
+void map_borders_dirty(const struct tile *ptile, int radius_sq);
+void map_borders_invalidate();
 void map_claim_border(struct tile *ptile, struct player *powner,
                       int radius_sq);
 void map_claim_ownership(struct tile *ptile, struct player *powner,
@@ -108,6 +108,7 @@ void kill_player(struct player *pplayer)
   struct player *barbarians = nullptr;
 
   pplayer->is_alive = false;
+  effect_cache_invalidate();
 
   // reset player status
   player_status_reset(pplayer);
@@ -163,7 +164,7 @@ void kill_player(struct player *pplayer)
          a radius of 3, give verbose messages of every unit transferred,
          and raze buildings according to raze chance (also removes palace) */
       if (transfer_city(pcity->original, pcity, 3, true, true, true, true)) {
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   pcity->original, "death-back_to_original");
       }
     }
@@ -206,7 +207,7 @@ void kill_player(struct player *pplayer)
     city_list_iterate_safe(pplayer->cities, pcity)
     {
       if (transfer_city(barbarians, pcity, -1, false, false, false, false)) {
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   barbarians, "death-barbarians_get");
       }
     }
@@ -3098,7 +3099,7 @@ struct player *civil_war(struct player *pplayer)
                       // TRANS: <city> ... the Poles.
                       _("%s declares allegiance to the %s."),
                       city_link(pcity), nation_plural_for_player(cplayer));
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   cplayer, "civil_war");
       }
       i--;
@@ -22,6 +22,7 @@
 #include "registry_ini.h"
 #include "shared.h"
 #include "support.h"
+#include "timing.h"
 
 // common
 #include "achievements.h"
@@ -8652,8 +8653,10 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
       *gamefile;
   bool ok = true;
   struct rscompat_info compat_info;
+  civtimer *loadtimer = timer_new(TIMER_CPU, TIMER_DEBUG);
 
   qInfo(_("Loading rulesets."));
+  timer_start(loadtimer);
 
   compat_info.compat_mode = compat_mode;
   compat_info.log_cb = logger;
@@ -8686,6 +8689,8 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
   } else {
     game.server.luadata = nullptr;
   }
+  qCDebug(timers_category, "Parsing ruleset files in %.3f seconds.",
+          timer_read_seconds(loadtimer));
 
   if (techfile == nullptr || buildfile == nullptr || govfile == nullptr
       || unitfile == nullptr || terrfile == nullptr || stylefile == nullptr
@@ -8790,6 +8795,11 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     rscompat_postprocess(&compat_info);
   }
 
+  if (ok) {
+    // The effects are final now.
+    ruleset_cache_compile();
+  }
+
   if (ok) {
     char **buffer = buffer_script ? &script_buffer : nullptr;
 
@@ -8842,6 +8852,11 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
     (void) aifill(game.info.aifill);
   }
 
+  timer_stop(loadtimer);
+  qCDebug(timers_category, "Loading rulesets in %.3f seconds.",
+          timer_read_seconds(loadtimer));
+  timer_destroy(loadtimer);
+
   return ok;
 }
 
@@ -130,6 +130,16 @@ static void check_fow(const char *file, const char *function, int line)
         SANITY_TILE(ptile, plr_tile->seen_count[v] < 30000);
         SANITY_TILE(ptile, plr_tile->own_seen[v] < 30000);
         SANITY_TILE(ptile, plr_tile->own_seen[v] <= plr_tile->seen_count[v]);
+        SANITY_TILE(ptile, map_tile_seen_by(ptile, v) != nullptr
+                               && BV_ISSET(*map_tile_seen_by(ptile, v),
+                                           player_index(pplayer))
+                                      == (0 < plr_tile->seen_count[v]));
+        SANITY_TILE(ptile,
+                    pplayer->server.tile_seen[v]->at(tile_index(ptile))
+                        == (0 < plr_tile->seen_count[v]));
+        SANITY_TILE(ptile,
+                    pplayer->server.tile_own_seen[v]->at(tile_index(ptile))
+                        == (0 < plr_tile->own_seen[v]));
       }
       vision_layer_iterate_end;
 
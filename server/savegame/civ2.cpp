@@ -1181,6 +1181,9 @@ bool load_civ2_save(const QString &path)
   if (!setup_cities(g, data)) {
     return false;
   }
+  // The terrain, extras and city tile owners were written directly.
+  map_hot_fields_sync(&(wld.map));
+
   // Barbarians can see everything
   if (data.players[0]) {
     map_know_and_see_all(data.players[0]);
@@ -1827,6 +1827,9 @@ static void sg_load_map(struct loaddata *loading)
       sg_load_map_tiles_specials(loading, true);
     }
 
+    // The loaders above write the tiles directly.
+    map_hot_fields_sync(&(wld.map));
+
     // Nothing more needed for a scenario.
     return;
   }
@@ -1853,6 +1856,9 @@ static void sg_load_map(struct loaddata *loading)
   sg_load_map_known(loading);
   sg_load_map_owner(loading);
   sg_load_map_worked(loading);
+
+  // The loaders above write the tiles directly.
+  map_hot_fields_sync(&(wld.map));
 }
 
 /**
@@ -2724,6 +2730,7 @@ static void sg_load_players(struct loaddata *loading)
   initialize_globals();
   unit_ordering_apply();
 
+  map_borders_invalidate();
   // All vision is ready; this calls city_thaw_workers_queue().
   map_calculate_borders();
 
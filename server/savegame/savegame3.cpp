@@ -65,12 +65,19 @@
 #include <fc_config.h>
 
 #include <QBitArray>
+#include <QByteArray>
+#include <QList>
 #include <QSet>
+#include <array>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <sstream>
+#include <utility> // std::as_const
+#include <vector>
 
 // utility
 #include "bitvector.h"
@@ -153,41 +160,6 @@ extern bool sg_success;
 #define SAVE_DUMMY_TURN_CHANGE_TIME 1
 #endif
 
-/*
- * This loops over the entire map to save data. It collects all the data of
- * a line using GET_XY_CHAR and then executes the macro SECFILE_INSERT_LINE.
- *
- * Parameters:
- *   ptile:         current tile within the line (used by GET_XY_CHAR)
- *   GET_XY_CHAR:   macro returning the map character for each position
- *   secfile:       a secfile struct
- *   secpath, ...:  path as used for sprintf() with arguments; the last item
- *                  will be the y coordinate
- * Example:
- *   SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), file, "map.t%04d");
- */
-#define SAVE_MAP_CHAR(ptile, GET_XY_CHAR, secfile, secpath, ...)            \
-  {                                                                         \
-    char _line[wld.map.xsize + 1];                                          \
-    int _nat_x, _nat_y;                                                     \
-                                                                            \
-    for (_nat_y = 0; _nat_y < wld.map.ysize; _nat_y++) {                    \
-      for (_nat_x = 0; _nat_x < wld.map.xsize; _nat_x++) {                  \
-        struct tile *ptile =                                                \
-            native_pos_to_tile(&(wld.map), _nat_x, _nat_y);                 \
-        fc_assert_action(ptile != nullptr, continue);                       \
-        _line[_nat_x] = (GET_XY_CHAR);                                      \
-        sg_failure_ret(QChar::isPrint(_line[_nat_x] & 0x7f),                \
-                       "Trying to write invalid map data at position "      \
-                       "(%d, %d) for path %s: '%c' (%d)",                   \
-                       _nat_x, _nat_y, secpath, _line[_nat_x],              \
-                       _line[_nat_x]);                                      \
-      }                                                                     \
-      _line[wld.map.xsize] = '\0';                                          \
-      secfile_insert_str(secfile, _line, secpath, ##__VA_ARGS__, _nat_y);   \
-    }                                                                       \
-  }
-
 /*
  * This loops over the entire map to load data. It inputs a line of data
  * using the macro SECFILE_LOOKUP_LINE and then loops using the macro
@@ -219,16 +191,24 @@ extern bool sg_success;
   {                                                                         \
     int _nat_x, _nat_y;                                                     \
     bool _printed_warning = false;                                          \
+    QByteArray _column;                                                     \
+    if (sg_binmap) {                                                        \
+      char _path[64];                                                       \
+      fc_snprintf(_path, sizeof(_path), secpath, ##__VA_ARGS__, 0);         \
+      _column = sg_load_map_column(secfile, _path);                         \
+    }                                                                       \
     for (_nat_y = 0; _nat_y < wld.map.ysize; _nat_y++) {                    \
       const char *_line =                                                   \
-          secfile_lookup_str(secfile, secpath, ##__VA_ARGS__, _nat_y);      \
+          (sg_binmap ? sg_map_column_line(_column, _nat_y)                  \
+                     : secfile_lookup_str(secfile, secpath, ##__VA_ARGS__,  \
+                                          _nat_y));                         \
       if (nullptr == _line) {                                               \
         char buf[64];                                                       \
         fc_snprintf(buf, sizeof(buf), secpath, ##__VA_ARGS__, _nat_y);      \
         qDebug("Line not found='%s'", buf);                                 \
         _printed_warning = true;                                            \
         continue;                                                           \
-      } else if (strlen(_line) != wld.map.xsize) {                          \
+      } else if (!sg_binmap && strlen(_line) != wld.map.xsize) {            \
         char buf[64];                                                       \
         fc_snprintf(buf, sizeof(buf), secpath, ##__VA_ARGS__, _nat_y);      \
         qDebug("Line too short (expected %d got %lu)='%s'", wld.map.xsize,  \
@@ -277,9 +257,27 @@ struct savedata {
 
 static const char savefile_options_default[] = " +version3";
 /* The following savefile option are added if needed:
- *  - nothing at current version
+ *  - binmap: map layers are stored as compressed columns instead of one
+ *    entry per line (setting 'binary_map').
  * See also calls to sg_save_savefile_options(). */
 
+// Whether the savefile being loaded or saved uses the "binmap" option.
+static bool sg_binmap = false;
+
+/* Writes map layers into a secfile. Returns false if the data is invalid
+ * and the save must fail. */
+using sg_map_writer = std::function<bool(struct section_file *)>;
+
+/* Map layers of a save whose conversion to secfile entries is left to
+ * savegame3_save_finish(). Every writer owns a raw copy of the tile data
+ * it needs and doesn't look at the game state. */
+struct sg_map_snapshot {
+  QList<sg_map_writer> writers;
+};
+
+// The snapshot being filled by savegame3_save_snapshot(), if any.
+static struct sg_map_snapshot *sg_snapshot = nullptr;
+
 static void savegame3_save_real(struct section_file *file,
                                 const char *save_reason, bool scenario);
 static struct loaddata *loaddata_new(struct section_file *file);
@@ -298,6 +296,18 @@ static enum unit_activity char2activity(char activity);
 static char *quote_block(const void *const data, int length);
 static int unquote_block(const char *const quoted_, void *dest,
                          int dest_length);
+static void sg_save_map_deferred(struct section_file *file,
+                                 sg_map_writer writer);
+static QByteArray sg_map_path(const char *format, ...)
+    fc__attribute((__format__(__printf__, 1, 2)));
+static QByteArray sg_terrain_chars();
+static void sg_write_map_layer(struct section_file *file,
+                               const QByteArray &column,
+                               const QByteArray &path, int xsize,
+                               bool binmap);
+static QByteArray sg_load_map_column(const struct section_file *file,
+                                     const char *path);
+static const char *sg_map_column_line(const QByteArray &column, int nat_y);
 static void worklist_load(struct section_file *file, struct worklist *pwl,
                           const char *path, ...);
 static void worklist_save(struct section_file *file,
@@ -307,7 +317,8 @@ static void unit_ordering_calc();
 static void unit_ordering_apply();
 static void sg_extras_set(bv_extras *extras, char ch,
                           struct extra_type **idx);
-static char sg_extras_get(bv_extras extras, struct extra_type *presource,
+static char sg_extras_get(bv_extras extras,
+                          const struct extra_type *presource,
                           const int *idx);
 static struct terrain *char2terrain(char ch);
 static char terrain2char(const struct terrain *pterrain);
@@ -430,6 +441,59 @@ void savegame3_save(struct section_file *sfile, const char *save_reason,
   timer_destroy(savetimer);
 }
 
+/**
+   Save the game like savegame3_save(), except for the map layers, which
+   make up most of a big savegame. Only the raw tile data they are made of
+   is copied to the returned snapshot, and savegame3_save_finish() must be
+   called to turn it into secfile entries. Unlike the rest of saving, that
+   doesn't need the game state and can be done in another thread while the
+   game goes on.
+ */
+struct sg_map_snapshot *savegame3_save_snapshot(struct section_file *sfile,
+                                                const char *save_reason,
+                                                bool scenario)
+{
+  fc_assert_ret_val(sfile != nullptr, nullptr);
+  fc_assert_ret_val(sg_snapshot == nullptr, nullptr);
+
+  sg_snapshot = new sg_map_snapshot;
+
+  savegame3_save(sfile, save_reason, scenario);
+
+  struct sg_map_snapshot *snapshot = sg_snapshot;
+  sg_snapshot = nullptr;
+
+  return snapshot;
+}
+
+/**
+   Add the map layers of the snapshot to the secfile and free the snapshot.
+   See savegame3_save_snapshot(). Returns FALSE if the map data is invalid;
+   the secfile must not be saved then.
+ */
+bool savegame3_save_finish(struct section_file *sfile,
+                           struct sg_map_snapshot *snapshot)
+{
+  bool success = true;
+
+  fc_assert_ret_val(sfile != nullptr, false);
+  fc_assert_ret_val(snapshot != nullptr, false);
+
+  for (const auto &writer : std::as_const(snapshot->writers)) {
+    if (!writer(sfile)) {
+      success = false;
+      break;
+    }
+  }
+
+  delete snapshot;
+
+  if (!success) {
+    qCritical("Failure saving savegame!");
+  }
+  return success;
+}
+
 /* =======================================================================
  * Basic load / save functions.
  * ======================================================================= */
@@ -512,6 +576,8 @@ static void savegame3_save_real(struct section_file *file,
   // initialise loading
   saving = savedata_new(file, save_reason, scenario);
   sg_success = true;
+  // Scenarios are meant to be edited by hand.
+  sg_binmap = game.server.save_binary_map && !scenario;
 
   // [scenario]
   /* This should be first section so scanning through all scenarios just for
@@ -882,6 +948,227 @@ static int unquote_block(const char *const quoted_, void *dest,
   return length;
 }
 
+/**
+   Returns the entry name of the map column whose first line would be
+   stored at 'path': the line number at the end is replaced with "col",
+   e.g. "map.t0000" becomes "map.tcol".
+ */
+static QByteArray sg_map_column_path(const char *path)
+{
+  QByteArray column_path(path);
+
+  fc_assert(column_path.endsWith("0000"));
+  column_path.chop(4);
+  column_path.append("col");
+
+  return column_path;
+}
+
+/**
+   Run the writer now, or keep it for savegame3_save_finish() when a
+   snapshot is being made. The writer must only use data it owns, since it
+   may run in the save thread while the game goes on.
+ */
+static void sg_save_map_deferred(struct section_file *file,
+                                 sg_map_writer writer)
+{
+  if (sg_snapshot != nullptr) {
+    sg_snapshot->writers.append(std::move(writer));
+  } else if (!writer(file)) {
+    sg_success = false;
+  }
+}
+
+/**
+   Returns the path of the first line of a map layer. The arguments are
+   the ones of the secfile path, the line number (0) being the last.
+ */
+static QByteArray sg_map_path(const char *format, ...)
+{
+  char path[64];
+  va_list args;
+
+  va_start(args, format);
+  fc_vsnprintf(path, sizeof(path), format, args);
+  va_end(args);
+
+  return QByteArray(path);
+}
+
+/**
+   Returns the save character of every terrain, by terrain number. Lets
+   the save thread write terrains without looking at the ruleset.
+ */
+static QByteArray sg_terrain_chars()
+{
+  QByteArray chars(terrain_count(), TERRAIN_UNKNOWN_IDENTIFIER);
+
+  terrain_type_iterate(pterrain)
+  {
+    chars[terrain_number(pterrain)] = terrain2char(pterrain);
+  }
+  terrain_type_iterate_end;
+
+  return chars;
+}
+
+/**
+   Fills column with a map layer with one character per tile, in native
+   order. get_char is called with the tile index. Returns FALSE if a
+   character can't be saved.
+ */
+template <typename F>
+static bool sg_map_column(int size, const QByteArray &path, F get_char,
+                          QByteArray &column)
+{
+  column = QByteArray(size, '\0');
+  char *data = column.data();
+
+  for (int i = 0; i < size; i++) {
+    data[i] = get_char(i);
+    if (!QChar::isPrint(data[i] & 0x7f)) {
+      log_sg("Trying to write invalid map data at index %d for path %s: "
+             "'%c' (%d)",
+             i, path.constData(), data[i], data[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+   Save a map layer with one character per tile. get_char is called with
+   the tile index, possibly in the save thread: it must only use data it
+   owns (see sg_save_map_deferred()). 'path' is the path of the first line.
+ */
+template <typename F>
+static void sg_save_map_chars(struct section_file *file,
+                              const QByteArray &path, F get_char)
+{
+  const int size = MAP_INDEX_SIZE;
+  const int xsize = wld.map.xsize;
+  const bool binmap = sg_binmap;
+
+  sg_save_map_deferred(file, [=](struct section_file *sfile) {
+    QByteArray column;
+
+    if (!sg_map_column(size, path, get_char, column)) {
+      return false;
+    }
+    sg_write_map_layer(sfile, column, path, xsize, binmap);
+    return true;
+  });
+}
+
+/**
+   Save a map layer with one number per tile, as lines of comma separated
+   numbers; -1 is written as "-". get_number is called with the tile index,
+   with the same restrictions as for sg_save_map_chars(). Some layers have
+   always ended their lines with a comma, which trailing_comma keeps.
+ */
+template <typename F>
+static void sg_save_map_numbers(struct section_file *file,
+                                const QByteArray &path, F get_number,
+                                bool trailing_comma)
+{
+  const int xsize = wld.map.xsize;
+  const int ysize = wld.map.ysize;
+
+  sg_save_map_deferred(file, [=](struct section_file *sfile) {
+    // Strip the line number of the first line.
+    const QByteArray prefix = path.chopped(4);
+    QByteArray line;
+
+    for (int y = 0; y < ysize; y++) {
+      line.clear();
+      for (int x = 0; x < xsize; x++) {
+        const int number = get_number(y * xsize + x);
+
+        if (number < 0) {
+          line.append('-');
+        } else {
+          line.append(QByteArray::number(number));
+        }
+        if (trailing_comma || x + 1 < xsize) {
+          line.append(',');
+        }
+      }
+      secfile_insert_str(sfile, line.constData(), "%s%04d",
+                         prefix.constData(), y);
+    }
+    return true;
+  });
+}
+
+/**
+   Insert a map layer into the secfile. With binmap, the column is
+   compressed on its own, which packs the mostly uniform layers much better
+   than separate lines do, and only one entry is added to the secfile.
+   Otherwise, there is one entry per line.
+
+   Doesn't access the game state, so that it can run in the save thread.
+ */
+static void sg_write_map_layer(struct section_file *file,
+                               const QByteArray &column,
+                               const QByteArray &path, int xsize,
+                               bool binmap)
+{
+  if (binmap) {
+    // Escaped strings are limited in length when written.
+    secfile_insert_str_noescape(
+        file, qCompress(column).toBase64().constData(), "%s",
+        sg_map_column_path(path.constData()).constData());
+    return;
+  }
+
+  // Strip the line number of the first line.
+  const QByteArray prefix = path.chopped(4);
+
+  for (int y = 0; y * xsize < column.size(); y++) {
+    secfile_insert_str(file, column.mid(y * xsize, xsize).constData(),
+                       "%s%04d", prefix.constData(), y);
+  }
+}
+
+/**
+   Load a map column saved by sg_write_map_layer(). Returns an empty array
+   if the column is missing or corrupt.
+ */
+static QByteArray sg_load_map_column(const struct section_file *file,
+                                     const char *path)
+{
+  const char *encoded =
+      secfile_lookup_str(file, "%s", sg_map_column_path(path).constData());
+  QByteArray column;
+
+  if (encoded == nullptr) {
+    return column;
+  }
+
+  column = qUncompress(QByteArray::fromBase64(encoded));
+  if (column.size() != wld.map.xsize * wld.map.ysize) {
+    qDebug("Map column '%s' has %d tiles, expected %d.", path,
+           static_cast<int>(column.size()), wld.map.xsize * wld.map.ysize);
+    column.clear();
+  }
+
+  return column;
+}
+
+/**
+   Returns the line nat_y of a map column, or nullptr if the column wasn't
+   loaded. The line is not nul-terminated.
+ */
+static const char *sg_map_column_line(const QByteArray &column, int nat_y)
+{
+  if (column.isEmpty()) {
+    return nullptr;
+  }
+
+  return column.constData() + nat_y * wld.map.xsize;
+}
+
 /**
    Load the worklist elements specified by path to the worklist pointed to
    by 'pwl'. 'pwl' should be a pointer to an existing worklist.
@@ -1058,7 +1345,8 @@ static void sg_extras_set(bv_extras *extras, char ch,
    Extras are packed in four to a character in hex notation. 'index'
    specifies which set of extras are included in this character.
  */
-static char sg_extras_get(bv_extras extras, struct extra_type *presource,
+static char sg_extras_get(bv_extras extras,
+                          const struct extra_type *presource,
                           const int *idx)
 {
   int i, bin = 0;
@@ -1205,6 +1493,8 @@ static void sg_load_savefile(struct loaddata *loading)
   // Load savefile options.
   loading->secfile_options =
       secfile_lookup_str(loading->file, "savefile.options");
+  sg_binmap = (loading->secfile_options != nullptr
+               && has_capability("binmap", loading->secfile_options));
 
   /* We don't need these entries, but read them anyway to avoid
    * warnings about unread secfile entries. */
@@ -1572,6 +1862,9 @@ static void sg_save_savefile(struct savedata *saving)
 
   // Save savefile options.
   sg_save_savefile_options(saving, savefile_options_default);
+  if (sg_binmap) {
+    sg_save_savefile_options(saving, " +binmap");
+  }
 
   secfile_insert_int(saving->file, current_compat_ver(), "savefile.version");
 
@@ -2516,6 +2809,9 @@ static void sg_load_map(struct loaddata *loading)
     sg_load_map_startpos(loading);
     sg_load_map_tiles_extras(loading);
 
+    // The loaders above write the tiles directly.
+    map_hot_fields_sync(&(wld.map));
+
     // Nothing more needed for a scenario.
     return;
   }
@@ -2531,6 +2827,9 @@ static void sg_load_map(struct loaddata *loading)
   sg_load_map_known(loading);
   sg_load_map_owner(loading);
   sg_load_map_worked(loading);
+
+  // The loaders above write the tiles directly.
+  map_hot_fields_sync(&(wld.map));
 }
 
 /**
@@ -2623,8 +2922,19 @@ static void sg_save_map_tiles(struct savedata *saving)
   sg_check_ret();
 
   // Save the terrain type.
-  SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), saving->file,
-                "map.t%04d");
+  {
+    const QByteArray chars = sg_terrain_chars();
+    const auto terrain = std::make_shared<const std::vector<signed char>>(
+        wld.map.hot->terrain);
+
+    sg_save_map_chars(saving->file, sg_map_path("map.t%04d", 0),
+                      [chars, terrain](int i) {
+                        const int number = (*terrain)[i];
+
+                        return (number < 0 ? TERRAIN_UNKNOWN_IDENTIFIER
+                                           : chars[number]);
+                      });
+  }
 
   // Save special tile sprites.
   whole_map_iterate(&(wld.map), ptile)
@@ -2691,10 +3001,23 @@ static void sg_save_map_tiles_extras(struct savedata *saving)
   // Check status and return if not OK (sg_success != TRUE).
   sg_check_ret();
 
+  /* Every layer below reads the extras of all tiles. Start from the hot
+   * copy and add the resources that are not in the bit vector (see
+   * sg_extras_get()) once, instead of walking the tiles for each layer. */
+  auto extras = std::make_shared<std::vector<bv_extras>>(
+      wld.map.hot->extras);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (ptile->resource != nullptr) {
+      BV_SET((*extras)[tile_index(ptile)], extra_index(ptile->resource));
+    }
+  }
+  whole_map_iterate_end;
+
   // Save extras.
   halfbyte_iterate_extras(j, game.control.num_extra_types)
   {
-    int mod[4];
+    std::array<int, 4> mod;
     int l;
 
     for (l = 0; l < 4; l++) {
@@ -2704,8 +3027,11 @@ static void sg_save_map_tiles_extras(struct savedata *saving)
         mod[l] = 4 * j + l;
       }
     }
-    SAVE_MAP_CHAR(ptile, sg_extras_get(ptile->extras, ptile->resource, mod),
-                  saving->file, "map.e%02d_%04d", j);
+    sg_save_map_chars(
+        saving->file, sg_map_path("map.e%02d_%04d", j, 0),
+        [extras, mod](int i) {
+          return sg_extras_get((*extras)[i], nullptr, mod.data());
+        });
   }
   halfbyte_iterate_extras_end;
 }
@@ -2983,7 +3309,9 @@ static void sg_load_map_owner(struct loaddata *loading)
  */
 static void sg_save_map_owner(struct savedata *saving)
 {
-  int x, y;
+  struct ownership {
+    int owner, source, eowner, placing, infra_turns;
+  };
 
   // Check status and return if not OK (sg_success != TRUE).
   sg_check_ret();
@@ -2993,114 +3321,43 @@ static void sg_save_map_owner(struct savedata *saving)
     return;
   }
 
-  // Store owner and ownership source as plain numbers.
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (!saving->save_players || tile_owner(ptile) == nullptr) {
-        qstrcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    player_number(tile_owner(ptile)));
-      }
-      strcat(line, token);
-      if (x + 1 < wld.map.xsize) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.owner%04d", y);
-  }
-
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (ptile->claimer == nullptr) {
-        qstrcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d", tile_index(ptile->claimer));
-      }
-      strcat(line, token);
-      if (x + 1 < wld.map.xsize) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.source%04d", y);
-  }
-
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (!saving->save_players || extra_owner(ptile) == nullptr) {
-        qstrcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    player_number(extra_owner(ptile)));
-      }
-      strcat(line, token);
-      if (x + 1 < wld.map.xsize) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.eowner%04d", y);
-  }
-
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (ptile->placing == nullptr) {
-        qstrcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    extra_number(ptile->placing));
-      }
-      strcat(line, token);
-      if (x + 1 < wld.map.xsize) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.placing%04d", y);
+  /* Copy the numbers to save, -1 standing for "-"; the lines are written
+   * from the copy by sg_save_map_numbers(). */
+  auto tiles = std::make_shared<std::vector<ownership>>(MAP_INDEX_SIZE);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    struct ownership &tile = (*tiles)[tile_index(ptile)];
+
+    tile.owner = (!saving->save_players || tile_owner(ptile) == nullptr
+                      ? -1
+                      : player_number(tile_owner(ptile)));
+    tile.source =
+        (ptile->claimer == nullptr ? -1 : tile_index(ptile->claimer));
+    tile.eowner = (!saving->save_players || extra_owner(ptile) == nullptr
+                       ? -1
+                       : player_number(extra_owner(ptile)));
+    tile.placing =
+        (ptile->placing == nullptr ? -1 : extra_number(ptile->placing));
+    tile.infra_turns = (ptile->placing != nullptr ? ptile->infra_turns : 0);
   }
+  whole_map_iterate_end;
 
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (ptile->placing != nullptr) {
-        fc_snprintf(token, sizeof(token), "%d", ptile->infra_turns);
-      } else {
-        fc_snprintf(token, sizeof(token), "0");
-      }
-      strcat(line, token);
-      if (x + 1 < wld.map.xsize) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.infra_turns%04d", y);
-  }
+  // Store owner and ownership source as plain numbers.
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.owner%04d", 0),
+      [tiles](int i) { return (*tiles)[i].owner; }, false);
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.source%04d", 0),
+      [tiles](int i) { return (*tiles)[i].source; }, false);
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.eowner%04d", 0),
+      [tiles](int i) { return (*tiles)[i].eowner; }, false);
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.placing%04d", 0),
+      [tiles](int i) { return (*tiles)[i].placing; }, false);
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.infra_turns%04d", 0),
+      [tiles](int i) { return (*tiles)[i].infra_turns; }, false);
 }
 
 /**
@@ -3152,8 +3409,6 @@ static void sg_load_map_worked(struct loaddata *loading)
  */
 static void sg_save_map_worked(struct savedata *saving)
 {
-  int x, y;
-
   // Check status and return if not OK (sg_success != TRUE).
   sg_check_ret();
 
@@ -3163,27 +3418,21 @@ static void sg_save_map_worked(struct savedata *saving)
   }
 
   // additionally save the tiles worked by the cities
-  for (y = 0; y < wld.map.ysize; y++) {
-    char line[wld.map.xsize * TOKEN_SIZE];
-
-    line[0] = '\0';
-    for (x = 0; x < wld.map.xsize; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-      struct city *pcity = tile_worked(ptile);
+  auto worked = std::make_shared<std::vector<int>>(MAP_INDEX_SIZE, -1);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    const struct city *pcity = tile_worked(ptile);
 
-      if (pcity == nullptr) {
-        qstrcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d", pcity->id);
-      }
-      strcat(line, token);
-      if (x < wld.map.xsize) {
-        strcat(line, ",");
-      }
+    if (pcity != nullptr) {
+      (*worked)[tile_index(ptile)] = pcity->id;
     }
-    secfile_insert_str(saving->file, line, "map.worked%04d", y);
   }
+  whole_map_iterate_end;
+
+  // These lines have always ended with a comma.
+  sg_save_map_numbers(
+      saving->file, sg_map_path("map.worked%04d", 0),
+      [worked](int i) { return (*worked)[i]; }, true);
 }
 
 /**
@@ -3265,46 +3514,70 @@ static void sg_save_map_known(struct savedata *saving)
     secfile_insert_bool(saving->file, game.server.save_options.save_known,
                         "game.save_known");
     if (game.server.save_options.save_known) {
-      int j, p, l, i;
-      QScopedArrayPointer<unsigned int> known(
-          new unsigned int[lines * MAP_INDEX_SIZE]());
-
-      /* HACK: we convert the data into a 32-bit integer, and then save it as
-       * hex. */
+      /* Only copy the known bits of the players here; the layers are built
+       * from them in sg_save_map_deferred(). */
+      QList<std::pair<int, QBitArray>> players_known;
+      QList<int> layers;
+      const int size = MAP_INDEX_SIZE;
+      const int xsize = wld.map.xsize;
+      const bool binmap = sg_binmap;
 
-      whole_map_iterate(&(wld.map), ptile)
+      players_iterate(pplayer)
       {
-        players_iterate(pplayer)
-        {
-          if (map_is_known(ptile, pplayer)) {
-            p = player_index(pplayer);
-            l = p / 32;
-            known[l * MAP_INDEX_SIZE + tile_index(ptile)] |=
-                (1u << (p % 32)); // "p % 32" = "p - l * 32"
-          }
-        }
-        players_iterate_end;
+        players_known.append({player_index(pplayer), *pplayer->tile_known});
       }
-      whole_map_iterate_end;
+      players_iterate_end;
 
-      for (l = 0; l < lines; l++) {
-        for (j = 0; j < 8; j++) {
-          for (i = 0; i < 4; i++) {
+      for (int l = 0; l < lines; l++) {
+        for (int j = 0; j < 8; j++) {
+          for (int i = 0; i < 4; i++) {
             /* Only bother saving the map for this halfbyte if at least one
              * of the corresponding player slots is in use */
             if (player_slot_is_used(
                     player_slot_by_number(l * 32 + j * 4 + i))) {
-              // put 4-bit segments of the 32-bit "known" field
-              SAVE_MAP_CHAR(
-                  ptile,
-                  bin2ascii_hex(
-                      known[l * MAP_INDEX_SIZE + tile_index(ptile)], j),
-                  saving->file, "map.k%02d_%04d", l * 8 + j);
+              layers.append(l * 8 + j);
               break;
             }
           }
         }
       }
+
+      sg_save_map_deferred(saving->file, [=](struct section_file *sfile) {
+        /* HACK: we convert the data into a 32-bit integer, and then save
+         * it as hex. */
+        std::vector<unsigned int> known(lines * size, 0);
+
+        for (const auto &[p, tile_known] : players_known) {
+          const int l = p / 32;
+
+          if (tile_known.isEmpty()) {
+            continue;
+          }
+          for (int i = 0; i < size; i++) {
+            if (tile_known.at(i)) {
+              known[l * size + i] |= (1u << (p % 32)); // "p - l * 32"
+            }
+          }
+        }
+
+        for (const int layer : layers) {
+          const int l = layer / 8, j = layer % 8;
+          const QByteArray path = sg_map_path("map.k%02d_%04d", layer, 0);
+          QByteArray column;
+
+          // put 4-bit segments of the 32-bit "known" field
+          if (!sg_map_column(
+                  size, path,
+                  [&](int i) {
+                    return bin2ascii_hex(known[l * size + i], j);
+                  },
+                  column)) {
+            return false;
+          }
+          sg_write_map_layer(sfile, column, path, xsize, binmap);
+        }
+        return true;
+      });
     }
   }
 }
@@ -3731,6 +4004,7 @@ static void sg_load_players(struct loaddata *loading)
   initialize_globals();
   unit_ordering_apply();
 
+  map_borders_invalidate();
   // All vision is ready; this calls city_thaw_workers_queue().
   map_calculate_borders();
 
@@ -6919,68 +7193,62 @@ static void sg_save_player_vision(struct savedata *saving,
     return;
   }
 
-  // Save the map (terrain).
-  SAVE_MAP_CHAR(ptile,
-                terrain2char(map_get_player_tile(ptile, plr)->terrain),
-                saving->file, "player%d.map_t%04d", plrno);
-
-  if (game.server.foggedborders) {
-    // Save the map (borders).
-    int x, y;
-
-    for (y = 0; y < wld.map.ysize; y++) {
-      char line[wld.map.xsize * TOKEN_SIZE];
-
-      line[0] = '\0';
-      for (x = 0; x < wld.map.xsize; x++) {
-        char token[TOKEN_SIZE];
-        struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-        struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+  /* Copy the private map of the player; the layers are written from the
+   * copy by sg_save_map_chars() and sg_save_map_numbers(). */
+  struct vision {
+    int terrain, owner, extras_owner;
+    const struct extra_type *resource;
+    bv_extras extras;
+    short last_updated;
+  };
+  auto tiles = std::make_shared<std::vector<vision>>(MAP_INDEX_SIZE);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    const struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+    struct vision &tile = (*tiles)[tile_index(ptile)];
+
+    tile.terrain = (plrtile->terrain == T_UNKNOWN
+                        ? -1
+                        : terrain_number(plrtile->terrain));
+    tile.owner =
+        (plrtile->owner == nullptr ? -1 : player_number(plrtile->owner));
+    tile.extras_owner = (plrtile->extras_owner == nullptr
+                             ? -1
+                             : player_number(plrtile->extras_owner));
+    tile.resource = plrtile->resource;
+    tile.extras = plrtile->extras;
+    tile.last_updated = plrtile->last_updated;
+  }
+  whole_map_iterate_end;
 
-        if (plrtile == nullptr || plrtile->owner == nullptr) {
-          qstrcpy(token, "-");
-        } else {
-          fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->owner));
-        }
-        strcat(line, token);
-        if (x < wld.map.xsize) {
-          strcat(line, ",");
-        }
-      }
-      secfile_insert_str(saving->file, line, "player%d.map_owner%04d", plrno,
-                         y);
-    }
+  // Save the map (terrain).
+  {
+    const QByteArray chars = sg_terrain_chars();
 
-    for (y = 0; y < wld.map.ysize; y++) {
-      char line[wld.map.xsize * TOKEN_SIZE];
+    sg_save_map_chars(saving->file,
+                      sg_map_path("player%d.map_t%04d", plrno, 0),
+                      [chars, tiles](int i) {
+                        const int number = (*tiles)[i].terrain;
 
-      line[0] = '\0';
-      for (x = 0; x < wld.map.xsize; x++) {
-        char token[TOKEN_SIZE];
-        struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-        struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+                        return (number < 0 ? TERRAIN_UNKNOWN_IDENTIFIER
+                                           : chars[number]);
+                      });
+  }
 
-        if (plrtile == nullptr || plrtile->extras_owner == nullptr) {
-          qstrcpy(token, "-");
-        } else {
-          fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->extras_owner));
-        }
-        strcat(line, token);
-        if (x < wld.map.xsize) {
-          strcat(line, ",");
-        }
-      }
-      secfile_insert_str(saving->file, line, "player%d.extras_owner%04d",
-                         plrno, y);
-    }
+  if (game.server.foggedborders) {
+    // Save the map (borders). These lines have always ended with a comma.
+    sg_save_map_numbers(
+        saving->file, sg_map_path("player%d.map_owner%04d", plrno, 0),
+        [tiles](int i) { return (*tiles)[i].owner; }, true);
+    sg_save_map_numbers(
+        saving->file, sg_map_path("player%d.extras_owner%04d", plrno, 0),
+        [tiles](int i) { return (*tiles)[i].extras_owner; }, true);
   }
 
   // Save the map (extras).
   halfbyte_iterate_extras(j, game.control.num_extra_types)
   {
-    int mod[4];
+    std::array<int, 4> mod;
     int l;
 
     for (l = 0; l < 4; l++) {
@@ -6991,21 +7259,24 @@ static void sg_save_player_vision(struct savedata *saving,
       }
     }
 
-    SAVE_MAP_CHAR(ptile,
-                  sg_extras_get(map_get_player_tile(ptile, plr)->extras,
-                                map_get_player_tile(ptile, plr)->resource,
-                                mod),
-                  saving->file, "player%d.map_e%02d_%04d", plrno, j);
+    sg_save_map_chars(
+        saving->file, sg_map_path("player%d.map_e%02d_%04d", plrno, j, 0),
+        [tiles, mod](int i) {
+          const struct vision &tile = (*tiles)[i];
+
+          return sg_extras_get(tile.extras, tile.resource, mod.data());
+        });
   }
   halfbyte_iterate_extras_end;
 
   // Save the map (update time).
   for (i = 0; i < 4; i++) {
     // put 4-bit segments of 16-bit "updated" field
-    SAVE_MAP_CHAR(
-        ptile,
-        bin2ascii_hex(map_get_player_tile(ptile, plr)->last_updated, i),
-        saving->file, "player%d.map_u%02d_%04d", plrno, i);
+    sg_save_map_chars(
+        saving->file, sg_map_path("player%d.map_u%02d_%04d", plrno, i, 0),
+        [tiles, i](int index) {
+          return bin2ascii_hex((*tiles)[index].last_updated, i);
+        });
   }
 
   // Save known cities.
@@ -13,3 +13,10 @@
 void savegame3_load(struct section_file *sfile);
 void savegame3_save(struct section_file *sfile, const char *save_reason,
                     bool scenario);
+
+struct sg_map_snapshot;
+struct sg_map_snapshot *savegame3_save_snapshot(struct section_file *sfile,
+                                                const char *save_reason,
+                                                bool scenario);
+bool savegame3_save_finish(struct section_file *sfile,
+                           struct sg_map_snapshot *snapshot);
@@ -146,6 +146,7 @@ void savegame_save(struct section_file *sfile, const char *save_reason,
 
 struct save_thread_data {
   struct section_file *sfile;
+  struct sg_map_snapshot *snapshot;
   char filepath[600];
   compress_type save_compress_type;
 };
@@ -158,7 +159,12 @@ static void save_thread_run(void *arg)
   struct save_thread_data *stdata =
       static_cast<struct save_thread_data *>(arg);
 
-  if (!secfile_save(stdata->sfile, stdata->filepath)) {
+  if (!savegame3_save_finish(stdata->sfile, stdata->snapshot)) {
+    // The map data is invalid, don't write a savegame that can't be loaded.
+    con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
+    notify_conn(nullptr, nullptr, E_LOG_ERROR, ftc_warning,
+                _("Failed saving game."));
+  } else if (!secfile_save(stdata->sfile, stdata->filepath)) {
     con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
     qCritical("Game saving failed: %s", secfile_error());
     notify_conn(nullptr, nullptr, E_LOG_ERROR, ftc_warning,
@@ -238,12 +244,13 @@ void save_game(const char *orig_filename, const char *save_reason,
   /* Allowing duplicates shouldn't be allowed. However, it takes very too
    * long time for huge game saving... */
   stdata->sfile = secfile_new(true);
-  savegame_save(stdata->sfile, save_reason, scenario);
+  stdata->snapshot =
+      savegame3_save_snapshot(stdata->sfile, save_reason, scenario);
 
-  /* We have consistent game state in stdata->sfile now, so
-   * we could pass it to the saving thread already. We want to
-   * handle below notify_conn() and directory creation in
-   * main thread, though. */
+  /* We have consistent game state in stdata->sfile and the map snapshot
+   * now, so we could pass them to the saving thread already. We want to
+   * handle below notify_conn() and directory creation in main thread,
+   * though. */
 
   // Append ".sav" to filename.
   sz_strlcat(stdata->filepath, ".sav");
@@ -308,11 +315,11 @@ void save_game(const char *orig_filename, const char *save_reason,
     sz_strlcpy(stdata->filepath, qUtf8Printable(tmpname));
   }
 
-  // Don't start another thread if game is being saved now
-  if (!save_thread->isRunning()) {
-    save_thread->set_func(save_thread_run, stdata);
-    save_thread->start(QThread::LowestPriority);
-  }
+  /* The thread only runs one save at a time. Usually, the previous one is
+   * long finished. */
+  save_thread->wait();
+  save_thread->set_func(save_thread_run, stdata);
+  save_thread->start(QThread::LowestPriority);
 
   log_time(QStringLiteral("Save time: %1 seconds")
                .arg(timer_read_seconds(timer_cpu)));
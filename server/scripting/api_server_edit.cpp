@@ -612,6 +612,7 @@ bool api_edit_change_terrain(lua_State *L, Tile *ptile, Terrain *pterr)
   fix_tile_on_terrain_change(ptile, old_terrain, false);
   if (need_to_reassign_continents(old_terrain, pterr)) {
     assign_continent_numbers();
+    map_borders_invalidate();
     send_all_known_tiles(nullptr);
   }
 
@@ -41,6 +41,11 @@
 static struct fc_lua *fcl_main = nullptr;
 static struct fc_lua *fcl_unsafe = nullptr;
 
+/**
+   Handles of the signals in fcl_main, resolved once when they are created.
+ */
+static struct signal *server_signals[SSIG_COUNT] = {nullptr};
+
 /**
    Optional game script code (useful for scenarios).
  */
@@ -337,6 +342,9 @@ void script_server_free()
     // luascript_signal_free() is called by luascript_destroy().
     luascript_destroy(fcl_main);
     fcl_main = nullptr;
+    for (auto &psignal : server_signals) {
+      psignal = nullptr;
+    }
   }
 
   if (fcl_unsafe != nullptr) {
@@ -370,15 +378,28 @@ void script_server_state_save(struct section_file *file)
 /**
    Invoke all the callback functions attached to a given signal.
  */
-void script_server_signal_emit(const char *signal_name, ...)
+void script_server_signal_emit(enum server_signal sig, ...)
 {
   va_list args;
 
-  va_start(args, signal_name);
-  luascript_signal_emit_valist(fcl_main, signal_name, args);
+  fc_assert_ret(server_signal_is_valid(sig));
+
+  va_start(args, sig);
+  luascript_signal_emit_handle_valist(fcl_main, server_signals[sig], args);
   va_end(args);
 }
 
+/**
+   Return the signal data of 'sig', including its statistics. Returns
+   nullptr if scripting isn't initialized.
+ */
+const struct signal *script_server_signal_get(enum server_signal sig)
+{
+  fc_assert_ret_val(server_signal_is_valid(sig), nullptr);
+
+  return server_signals[sig];
+}
+
 /**
    Declare any new signal types you need here.
  */
@@ -500,6 +521,12 @@ static void script_server_signals_create()
 
   luascript_signal_create(fcl_main, "action_started_unit_self", 2,
                           API_TYPE_ACTION, API_TYPE_UNIT);
+
+  for (int sig = 0; sig < SSIG_COUNT; sig++) {
+    server_signals[sig] = luascript_signal_find(
+        fcl_main, server_signal_name(server_signal(sig)));
+    fc_assert(server_signals[sig] != nullptr);
+  }
 }
 
 /**
@@ -16,8 +16,74 @@
 /* common/scriptcore */
 #include "luascript_types.h"
 
+// Signals emitted by the server, see script_server_signals_create().
+#define SPECENUM_NAME server_signal
+#define SPECENUM_VALUE0 SSIG_TURN_BEGIN
+#define SPECENUM_VALUE0NAME "turn_begin"
+#define SPECENUM_VALUE1 SSIG_TURN_STARTED
+#define SPECENUM_VALUE1NAME "turn_started"
+#define SPECENUM_VALUE2 SSIG_UNIT_MOVED
+#define SPECENUM_VALUE2NAME "unit_moved"
+#define SPECENUM_VALUE3 SSIG_CITY_BUILT
+#define SPECENUM_VALUE3NAME "city_built"
+#define SPECENUM_VALUE4 SSIG_CITY_SIZE_CHANGE
+#define SPECENUM_VALUE4NAME "city_size_change"
+#define SPECENUM_VALUE5 SSIG_CITY_GROWTH
+#define SPECENUM_VALUE5NAME "city_growth"
+#define SPECENUM_VALUE6 SSIG_UNIT_BUILT
+#define SPECENUM_VALUE6NAME "unit_built"
+#define SPECENUM_VALUE7 SSIG_BUILDING_BUILT
+#define SPECENUM_VALUE7NAME "building_built"
+#define SPECENUM_VALUE8 SSIG_UNIT_CANT_BE_BUILT
+#define SPECENUM_VALUE8NAME "unit_cant_be_built"
+#define SPECENUM_VALUE9 SSIG_BUILDING_CANT_BE_BUILT
+#define SPECENUM_VALUE9NAME "building_cant_be_built"
+#define SPECENUM_VALUE10 SSIG_BUILDING_LOST
+#define SPECENUM_VALUE10NAME "building_lost"
+#define SPECENUM_VALUE11 SSIG_TECH_RESEARCHED
+#define SPECENUM_VALUE11NAME "tech_researched"
+#define SPECENUM_VALUE12 SSIG_CITY_DESTROYED
+#define SPECENUM_VALUE12NAME "city_destroyed"
+#define SPECENUM_VALUE13 SSIG_CITY_LOOT
+#define SPECENUM_VALUE13NAME "city_loot"
+#define SPECENUM_VALUE14 SSIG_CITY_TRANSFERRED
+#define SPECENUM_VALUE14NAME "city_transferred"
+#define SPECENUM_VALUE15 SSIG_CITY_LOST
+#define SPECENUM_VALUE15NAME "city_lost"
+#define SPECENUM_VALUE16 SSIG_HUT_ENTER
+#define SPECENUM_VALUE16NAME "hut_enter"
+#define SPECENUM_VALUE17 SSIG_HUT_FRIGHTEN
+#define SPECENUM_VALUE17NAME "hut_frighten"
+#define SPECENUM_VALUE18 SSIG_UNIT_LOST
+#define SPECENUM_VALUE18NAME "unit_lost"
+#define SPECENUM_VALUE19 SSIG_DISASTER_OCCURRED
+#define SPECENUM_VALUE19NAME "disaster_occurred"
+#define SPECENUM_VALUE20 SSIG_NUKE_EXPLODED
+#define SPECENUM_VALUE20NAME "nuke_exploded"
+#define SPECENUM_VALUE21 SSIG_DISASTER
+#define SPECENUM_VALUE21NAME "disaster"
+#define SPECENUM_VALUE22 SSIG_ACHIEVEMENT_GAINED
+#define SPECENUM_VALUE22NAME "achievement_gained"
+#define SPECENUM_VALUE23 SSIG_MAP_GENERATED
+#define SPECENUM_VALUE23NAME "map_generated"
+#define SPECENUM_VALUE24 SSIG_PULSE
+#define SPECENUM_VALUE24NAME "pulse"
+#define SPECENUM_VALUE25 SSIG_ACTION_STARTED_UNIT_UNIT
+#define SPECENUM_VALUE25NAME "action_started_unit_unit"
+#define SPECENUM_VALUE26 SSIG_ACTION_STARTED_UNIT_UNITS
+#define SPECENUM_VALUE26NAME "action_started_unit_units"
+#define SPECENUM_VALUE27 SSIG_ACTION_STARTED_UNIT_CITY
+#define SPECENUM_VALUE27NAME "action_started_unit_city"
+#define SPECENUM_VALUE28 SSIG_ACTION_STARTED_UNIT_TILE
+#define SPECENUM_VALUE28NAME "action_started_unit_tile"
+#define SPECENUM_VALUE29 SSIG_ACTION_STARTED_UNIT_SELF
+#define SPECENUM_VALUE29NAME "action_started_unit_self"
+#define SPECENUM_COUNT SSIG_COUNT
+#include "specenum_gen.h"
+
 struct section_file;
 struct connection;
+struct signal;
 
 void script_server_remove_exported_object(void *object);
 
@@ -39,7 +105,8 @@ void script_server_state_load(struct section_file *file);
 void script_server_state_save(struct section_file *file);
 
 // Signals.
-void script_server_signal_emit(const char *signal_name, ...);
+void script_server_signal_emit(enum server_signal sig, ...);
+const struct signal *script_server_signal_get(enum server_signal sig);
 
 // Functions
 bool script_server_call(const char *func_name, ...);
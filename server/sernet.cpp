@@ -322,6 +322,8 @@ int server_make_connection(QIODevice *new_sock, const QString &client_addr,
       pconn->last_request_id_seen = 0;
       pconn->auth_tries = 0;
       pconn->auth_settime = 0;
+      pconn->resume.requested = false;
+      pconn->resume.accepted = false;
       pconn->status = AS_NOT_ESTABLISHED;
       pconn->ping_timers = new QList<civtimer *>;
       pconn->granted_access_level = pconn->access_level;
@@ -445,7 +447,7 @@ void init_connections()
   int i;
 
   game.all_connections = conn_list_new();
-  game.est_connections = conn_list_new();
+  game.est_connections = conn_list_new_pooled();
   game.glob_observers = conn_list_new();
 
   for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
@@ -839,7 +839,8 @@ void server::begin_phase()
         struct mapdef *pmapdef = mapimg_isvalid(i);
         if (pmapdef != nullptr) {
           mapimg_create(pmapdef, false, game.server.save_name,
-                        qUtf8Printable(srvarg.saves_pathname));
+                        qUtf8Printable(srvarg.saves_pathname),
+                        game.server.threaded_save);
         } else {
           qCritical("%s", mapimg_error());
         }
@@ -1134,7 +1135,7 @@ void server::pulse()
   finish_unit_waits();
 
   call_ai_refresh();
-  script_server_signal_emit("pulse");
+  script_server_signal_emit(SSIG_PULSE);
   (void) send_server_info_to_metaserver(META_REFRESH);
   if (current_turn_timeout() > 0 && S_S_RUNNING == server_state()
       && game.server.phase_timer
@@ -57,6 +57,15 @@ struct server_connection : public connection {
     struct player *playing;
     bool observer;
   } delegation;
+
+  /// The session the client asked to resume when connecting, see
+  /// session.cpp.
+  struct {
+    bool requested; ///< Asked before the connection was accepted
+    bool accepted;  ///< Can be resumed when the player is attached
+    char token[MAX_LEN_SESSION_TOKEN];
+    unsigned int stamp;
+  } resume;
 };
 
 server_connection *conn_by_user(const char *user_name);
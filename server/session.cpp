@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: Freeciv21 and Freeciv Contributors
+
+// self
+#include "session.h"
+
+// utility
+#include "log.h"
+#include "support.h"
+
+// common
+#include "city.h"
+#include "game.h"
+#include "map.h"
+#include "packets.h"
+#include "player.h"
+#include "unit.h"
+#include "unitlist.h"
+#include "vision.h"
+
+// server
+#include "citytools.h"
+#include "maphand.h"
+#include "server_connection.h"
+#include "srv_main.h"
+#include "unittools.h"
+
+// Qt
+#include <QUuid>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ *
+ * Session resumption. Every player is given a token and, every now and
+ * then, a stamp telling which changes its clients have received. A client
+ * that loses its connection presents both when it reconnects, keeps its
+ * game state, and gets only the tiles, cities and units that changed
+ * since. Changes are tracked by stamping tiles (which also covers the
+ * cities on them) and units, and by remembering which cities and units
+ * clients were told to remove.
+ */
+
+namespace {
+
+/// A city or unit that clients were told to forget.
+struct session_removal {
+  unsigned int stamp;
+  int id;
+};
+
+/// Forget the oldest removals past this count. Sessions older than the
+/// last forgotten one can't be resumed anymore.
+constexpr std::size_t MAX_SESSION_REMOVALS = 8192;
+
+/// Changes are stamped with this. Increased every time clients are told
+/// which changes they received.
+unsigned int current_stamp = 1;
+/// Sessions last synchronized before this can't be resumed.
+unsigned int oldest_stamp = 0;
+/// While positive, changes aren't stamped (the information is merely
+/// resent).
+int frozen_level = 0;
+
+/// Last change of every tile, by tile index.
+std::vector<unsigned int> tile_stamps;
+/// Last change of every unit that still exists, by id.
+std::unordered_map<int, unsigned int> unit_stamps;
+std::deque<session_removal> city_removals;
+std::deque<session_removal> unit_removals;
+
+} // anonymous namespace
+
+/**
+ * Records that clients were told to remove the object with the given id.
+ */
+static void session_log_removal(std::deque<session_removal> &removals,
+                                int id)
+{
+  removals.push_back({current_stamp, id});
+  if (removals.size() > MAX_SESSION_REMOVALS) {
+    oldest_stamp = std::max(oldest_stamp, removals.front().stamp);
+    removals.pop_front();
+  }
+}
+
+/**
+ * Returns the last time the tile changed, or 0 if it didn't.
+ */
+static unsigned int session_tile_stamp(const struct tile *ptile)
+{
+  const auto index = static_cast<std::size_t>(tile_index(ptile));
+
+  return index < tile_stamps.size() ? tile_stamps[index] : 0;
+}
+
+/**
+ * Returns whether a player gets information about the unit. Must match
+ * send_unit_info().
+ */
+static bool session_player_sees_unit(const struct player *pplayer,
+                                     const struct unit *punit)
+{
+  const struct player *powner = unit_owner(punit);
+
+  return (pplayer == powner || players_on_same_team(pplayer, powner)
+          || can_player_see_unit(pplayer, punit));
+}
+
+/**
+ * Returns whether the connection can resume the session it asked for:
+ * its token must be the one of the player it will be attached to, and
+ * the changes since it was last synchronized must all be known and
+ * cheaper to send than the whole map.
+ */
+static bool session_can_resume(const server_connection *pconn)
+{
+  const struct player *pplayer = player_by_user(pconn->username);
+  const unsigned int since = pconn->resume.stamp;
+
+  if (S_S_RUNNING != server_state() && S_S_OVER != server_state()) {
+    return false;
+  }
+
+  if (nullptr == pplayer || '\0' == pplayer->server.session_token[0]
+      || 0 != strcmp(pplayer->server.session_token, pconn->resume.token)) {
+    return false;
+  }
+
+  if (since < oldest_stamp || since >= current_stamp) {
+    log_debug("Session of %s is too old to be resumed.", pconn->username);
+    return false;
+  }
+
+  const auto changed =
+      std::count_if(tile_stamps.begin(), tile_stamps.end(),
+                    [since](unsigned int stamp) { return stamp > since; });
+  if (changed > MAP_INDEX_SIZE / 2) {
+    log_debug("Too much changed since the session of %s.", pconn->username);
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Forgets all changes. Sessions started before can't be resumed.
+ */
+void session_free()
+{
+  oldest_stamp = current_stamp;
+  tile_stamps.clear();
+  unit_stamps.clear();
+  city_removals.clear();
+  unit_removals.clear();
+}
+
+/**
+ * Stops stamping changes, for instance while resending information to a
+ * connection. Calls may be nested.
+ */
+void session_stamps_freeze() { frozen_level++; }
+
+/**
+ * Resumes stamping changes.
+ */
+void session_stamps_thaw()
+{
+  frozen_level--;
+  fc_assert(frozen_level >= 0);
+}
+
+/**
+ * Records that clients are being told about a change on the tile or the
+ * city on it.
+ */
+void session_tile_changed(const struct tile *ptile)
+{
+  if (frozen_level > 0) {
+    return;
+  }
+
+  if (tile_stamps.size() != static_cast<std::size_t>(MAP_INDEX_SIZE)) {
+    tile_stamps.assign(MAP_INDEX_SIZE, 0);
+  }
+  tile_stamps[tile_index(ptile)] = current_stamp;
+}
+
+/**
+ * Records that clients are being told about a change of the unit,
+ * including it being seen or going out of sight.
+ */
+void session_unit_changed(const struct unit *punit)
+{
+  if (frozen_level > 0) {
+    return;
+  }
+
+  unit_stamps[punit->id] = current_stamp;
+}
+
+/**
+ * Records that clients are told to remove a city.
+ */
+void session_city_removed(int city_id)
+{
+  session_log_removal(city_removals, city_id);
+}
+
+/**
+ * Records that a unit is removed from the game.
+ */
+void session_unit_removed(int unit_id)
+{
+  unit_stamps.erase(unit_id);
+  session_log_removal(unit_removals, unit_id);
+}
+
+/**
+ * Handles a request to resume a session. It comes before the join
+ * request so the decision can be made when the connection is accepted.
+ */
+void handle_session_resume_req(server_connection *pconn,
+                               const struct packet_session_resume_req *req)
+{
+  if (pconn->established) {
+    qDebug("%s asked to resume a session after joining.",
+           conn_description(pconn));
+    return;
+  }
+
+  pconn->resume.requested = true;
+  sz_strlcpy(pconn->resume.token, req->token);
+  pconn->resume.stamp = req->stamp;
+}
+
+/**
+ * Tells a newly accepted connection whether its session is resumed.
+ * Returns true if it is: the client then keeps its rulesets and map, and
+ * session_resume() must be called when it is attached to its player.
+ */
+bool session_resume_accept(server_connection *pconn)
+{
+  if (!pconn->resume.requested) {
+    return false;
+  }
+
+  pconn->resume.requested = false;
+  pconn->resume.accepted = session_can_resume(pconn);
+  dsend_packet_session_resume_reply(pconn, pconn->resume.accepted);
+
+  return pconn->resume.accepted;
+}
+
+/**
+ * Sends what changed since the session of a connection was last
+ * synchronized, instead of send_all_info(). Returns false if the session
+ * wasn't resumed.
+ */
+bool session_resume(server_connection *pconn)
+{
+  if (!pconn->resume.accepted) {
+    return false;
+  }
+
+  pconn->resume.accepted = false;
+  if (nullptr == pconn->playing
+      || 0 != strcmp(pconn->playing->server.session_token,
+                     pconn->resume.token)) {
+    qCritical("%s resumed a session of another player.",
+              conn_description(pconn));
+    return false;
+  }
+
+  send_all_changed_info(pconn, pconn->resume.stamp);
+  return true;
+}
+
+/**
+ * Sends the tiles, cities and units that changed since the given stamp,
+ * and removes those that went away.
+ */
+void session_send_changes(server_connection *pconn, unsigned int since)
+{
+  struct conn_list *dest = pconn->self;
+  struct player *pplayer = pconn->playing;
+
+  fc_assert_ret(nullptr != pplayer);
+
+  session_stamps_freeze();
+  conn_list_do_buffer(dest);
+
+  // Removals first, in case new objects replaced them.
+  for (const auto &removal : city_removals) {
+    if (removal.stamp <= since) {
+      continue;
+    }
+
+    const struct city *pcity = game_city_by_number(removal.id);
+    const struct vision_site *psite =
+        (nullptr != pcity ? map_get_player_site(city_tile(pcity), pplayer)
+                          : nullptr);
+    if (nullptr == psite || psite->identity != removal.id) {
+      dsend_packet_city_remove(pconn, removal.id);
+    }
+  }
+  for (const auto &removal : unit_removals) {
+    if (removal.stamp > since) {
+      dsend_packet_unit_remove(pconn, removal.id);
+    }
+  }
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (session_tile_stamp(ptile) > since) {
+      send_tile_info(dest, ptile, true);
+      if (nullptr != map_get_player_site(ptile, pplayer)) {
+        send_city_info_at_tile(pplayer, dest, nullptr, ptile);
+      }
+    }
+  }
+  whole_map_iterate_end;
+
+  players_iterate(unitowner)
+  {
+    unit_list_iterate(unitowner->units, punit)
+    {
+      auto stamp = unit_stamps.find(punit->id);
+
+      if (stamp == unit_stamps.end() || stamp->second <= since) {
+        continue;
+      }
+      if (session_player_sees_unit(pplayer, punit)) {
+        send_unit_info(dest, punit);
+      } else {
+        dsend_packet_unit_remove(pconn, punit->id);
+      }
+    }
+    unit_list_iterate_end;
+  }
+  players_iterate_end;
+
+  conn_list_do_unbuffer(dest);
+  session_stamps_thaw();
+}
+
+/**
+ * Gives the connections playing a player the token and stamp to resume
+ * their session with. They have received every change made until now.
+ */
+void send_session_info(struct conn_list *dest)
+{
+  conn_list_iterate(dest, pconn)
+  {
+    struct player *pplayer = pconn->playing;
+
+    if (nullptr == pplayer) {
+      continue;
+    }
+
+    if ('\0' == pplayer->server.session_token[0]) {
+      sz_strlcpy(pplayer->server.session_token,
+                 qUtf8Printable(QUuid::createUuid().toString(QUuid::Id128)));
+    }
+    dsend_packet_session_info(pconn, pplayer->server.session_token,
+                              current_stamp);
+  }
+  conn_list_iterate_end;
+
+  current_stamp++;
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: Freeciv21 and Freeciv Contributors
+
+#pragma once
+
+struct conn_list;
+struct packet_session_resume_req;
+struct server_connection;
+struct tile;
+struct unit;
+
+void session_free();
+
+void session_stamps_freeze();
+void session_stamps_thaw();
+
+void session_tile_changed(const struct tile *ptile);
+void session_unit_changed(const struct unit *punit);
+void session_city_removed(int city_id);
+void session_unit_removed(int unit_id);
+
+void handle_session_resume_req(server_connection *pconn,
+                               const struct packet_session_resume_req *req);
+bool session_resume_accept(server_connection *pconn);
+bool session_resume(server_connection *pconn);
+void session_send_changes(server_connection *pconn, unsigned int since);
+
+void send_session_info(struct conn_list *dest);
@@ -2936,6 +2936,31 @@ static struct setting settings[] = {
                 "are not required to wait for the save to finish."),
              nullptr, nullptr, GAME_DEFAULT_THREADED_SAVE),
 
+    GEN_BOOL("binary_map", game.server.save_binary_map, SSET_META,
+             SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+             N_("Whether to save map layers in binary form"),
+             N_("If this is turned on, each map layer (terrain, extras, "
+                "known tiles and the players' view of the map) is saved as "
+                "a single compressed block instead of one line of text per "
+                "map row. Saving and loading big maps is much faster, but "
+                "the map can no longer be edited by hand and the savegame "
+                "cannot be loaded by older servers. Scenarios are always "
+                "saved as text."),
+             nullptr, nullptr, GAME_DEFAULT_SAVE_BINARY_MAP),
+
+    GEN_BOOL("parallel_ai", game.server.parallel_ai, SSET_META,
+             SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+             N_("Whether to plan AI players in parallel"),
+             N_("If this is turned on, the AI players assess the dangers "
+                "to their cities at the same time on several processor "
+                "cores at the beginning of the phase, before any of them "
+                "moves. They then move their units one after another as "
+                "usual. This makes AI turns faster when there are many AI "
+                "players, but the AI sees the map as it was at the start "
+                "of the phase rather than after the moves of the AI "
+                "players before it."),
+             nullptr, nullptr, GAME_DEFAULT_PARALLEL_AI),
+
     GEN_ENUM("compresstype", game.server.save_compress_type, SSET_META,
              SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
              N_("Savegame compression algorithm"),
@@ -15,6 +15,10 @@
 #include "shared.h"
 #include "timing.h"
 
+// Qt
+#include <QCoreApplication>
+#include <QThread>
+
 // common
 #include "ai.h"
 #include "city.h"
@@ -32,6 +36,7 @@
 #include "srv_log.h"
 
 static civtimer *aitimer[AIT_LAST][2];
+static int aicount[AIT_LAST][2];
 static int recursion[AIT_LAST];
 
 // General AI logging functions
@@ -79,21 +84,50 @@ QString unit_log_prefix(const unit *punit)
                            TILE_XY(unit_tile(punit)), gx, gy, aibuf);
 }
 
+/**
+   Returns whether the caller runs in the main thread. The timers and
+   counters are shared, so only the main thread updates them.
+ */
+static bool timing_main_thread()
+{
+  return QCoreApplication::instance() == nullptr
+         || QThread::currentThread()
+                == QCoreApplication::instance()->thread();
+}
+
+/**
+   Clear the per turn timers and counters when a new turn has started.
+   Returns TRUE if that was the case.
+ */
+static bool timing_turn_check()
+{
+  static int turn = -1;
+  int i;
+
+  if (game.info.turn == turn) {
+    return false;
+  }
+
+  turn = game.info.turn;
+  for (i = 0; i < AIT_LAST; i++) {
+    timer_clear(aitimer[i][0]);
+    aicount[i][0] = 0;
+  }
+
+  return true;
+}
+
 /**
    Measure the time between the calls.  Used to see where in the AI too
    much CPU is being used.
  */
 void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity)
 {
-  static int turn = -1;
-
-  if (game.info.turn != turn) {
-    int i;
+  if (!timing_main_thread()) {
+    return;
+  }
 
-    turn = game.info.turn;
-    for (i = 0; i < AIT_LAST; i++) {
-      timer_clear(aitimer[i][0]);
-    }
+  if (timing_turn_check()) {
     fc_assert(activity == TIMER_START);
   }
 
@@ -108,6 +142,20 @@ void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity)
   }
 }
 
+/**
+   Count how many times the work measured by 'timer' was done.
+ */
+void timing_count_real(enum ai_timer timer, int count)
+{
+  if (!timing_main_thread()) {
+    return;
+  }
+
+  timing_turn_check();
+  aicount[timer][0] += count;
+  aicount[timer][1] += count;
+}
+
 /**
    Print results
  */
@@ -122,6 +170,15 @@ void timing_results_real()
   qCInfo(timers_category, "%s", buf);                                       \
   notify_conn(nullptr, nullptr, E_AI_DEBUG, ftc_log, "%s", buf);
 
+#define AILOG_COUNT_OUT(text, which)                                        \
+  fc_snprintf(buf, sizeof(buf),                                             \
+              "  %s: %g sec turn, %g sec game, %d turn, %d game", text,     \
+              timer_read_seconds(aitimer[which][0]),                        \
+              timer_read_seconds(aitimer[which][1]), aicount[which][0],     \
+              aicount[which][1]);                                           \
+  qCInfo(timers_category, "%s", buf);                                       \
+  notify_conn(nullptr, nullptr, E_AI_DEBUG, ftc_log, "%s", buf);
+
   qCInfo(timers_category, "  --- AI timing results ---");
 
   notify_conn(nullptr, nullptr, E_AI_DEBUG, ftc_log,
@@ -153,7 +210,9 @@ void timing_results_real()
   AILOG_OUT(" - Worker want", AIT_CITY_TERRAIN);
   AILOG_OUT(" - Military want", AIT_CITY_MILITARY);
   AILOG_OUT(" - Settler want", AIT_CITY_SETTLERS);
-  AILOG_OUT("Citizen arrange", AIT_CITIZEN_ARRANGE);
+  AILOG_COUNT_OUT("Citizen arrange", AIT_CITIZEN_ARRANGE);
+  AILOG_COUNT_OUT("City refresh queue", AIT_CITY_REFRESH);
+  AILOG_COUNT_OUT("City info sent from queue", AIT_CITY_SEND);
   AILOG_OUT("Tech", AIT_TECH);
 }
 
@@ -167,6 +226,8 @@ void timing_log_init()
   for (i = 0; i < AIT_LAST; i++) {
     aitimer[i][0] = timer_new(TIMER_CPU, TIMER_ACTIVE);
     aitimer[i][1] = timer_new(TIMER_CPU, TIMER_ACTIVE);
+    aicount[i][0] = 0;
+    aicount[i][1] = 0;
     recursion[i] = 0;
   }
 }
@@ -50,6 +50,8 @@ enum ai_timer {
   AIT_TAXES,
   AIT_CITIES,
   AIT_CITIZEN_ARRANGE,
+  AIT_CITY_REFRESH,
+  AIT_CITY_SEND,
   AIT_BUILDINGS,
   AIT_DANGER,
   AIT_TECH,
@@ -112,12 +114,15 @@ void timing_log_init();
 void timing_log_free();
 
 void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity);
+void timing_count_real(enum ai_timer timer, int count);
 void timing_results_real();
 
 #ifdef FREECIV_DEBUG
 #define TIMING_LOG(timer, activity) timing_log_real(timer, activity)
+#define TIMING_COUNT(timer, count) timing_count_real(timer, count)
 #define TIMING_RESULTS() timing_results_real()
 #else // FREECIV_DEBUG
 #define TIMING_LOG(timer, activity)
+#define TIMING_COUNT(timer, count)
 #define TIMING_RESULTS()
 #endif // FREECIV_DEBUG
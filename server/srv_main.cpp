@@ -18,6 +18,7 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QThreadPool>
 
 // utility
 #include "bitvector.h"
@@ -79,6 +80,7 @@
 #include "sernet.h"
 #include "server_connection.h"
 #include "server_settings.h"
+#include "session.h"
 #include "settings.h"
 #include "spacerace.h"
 #include "srv_log.h"
@@ -591,11 +593,9 @@ bool check_for_game_over()
 }
 
 /**
-   Send all information for when game starts or client reconnects.
-   Initial packets should have been sent before calling this function.
-   See comment in connecthand.c::establish_new_connection().
+   Send the information send_all_info() sends before the map.
  */
-void send_all_info(struct conn_list *dest)
+static void send_all_info_head(struct conn_list *dest)
 {
   conn_list_iterate(dest, pconn)
   {
@@ -612,14 +612,51 @@ void send_all_info(struct conn_list *dest)
       send_research_info(&presearch, dest);
     }
   };
+}
+
+/**
+   Send the information send_all_info() sends after the map, cities and
+   units.
+ */
+static void send_all_info_tail(struct conn_list *dest)
+{
+  send_spaceship_info(nullptr, dest);
+
+  cities_iterate(pcity) { package_and_send_worker_tasks(pcity); }
+  cities_iterate_end;
+
+  send_session_info(dest);
+}
+
+/**
+   Send all information for when game starts or client reconnects.
+   Initial packets should have been sent before calling this function.
+   See comment in connecthand.c::establish_new_connection().
+ */
+void send_all_info(struct conn_list *dest)
+{
+  send_all_info_head(dest);
+
+  // Nothing changes, it is only resent.
+  session_stamps_freeze();
   send_map_info(dest);
   send_all_known_tiles(dest);
   send_all_known_cities(dest);
   send_all_known_units(dest);
-  send_spaceship_info(nullptr, dest);
+  session_stamps_thaw();
 
-  cities_iterate(pcity) { package_and_send_worker_tasks(pcity); }
-  cities_iterate_end;
+  send_all_info_tail(dest);
+}
+
+/**
+   Like send_all_info(), but for a client resuming its session: the map,
+   cities and units are only sent if they changed since the stamp.
+ */
+void send_all_changed_info(server_connection *pconn, unsigned int since)
+{
+  send_all_info_head(pconn->self);
+  session_send_changes(pconn, since);
+  send_all_info_tail(pconn->self);
 }
 
 /**
@@ -1051,11 +1088,45 @@ static void kill_dying_players()
   }
 }
 
+/**
+   Runs the read-only planning stage of the AI players of the phase
+   concurrently. The game state is frozen meanwhile; the players then act
+   one after another in first_activities, in the usual order.
+ */
+static void ai_plan_phase()
+{
+  QThreadPool pool;
+  civtimer *plantimer = timer_new(TIMER_USER, TIMER_DEBUG);
+
+  timer_start(plantimer);
+  effect_cache_freeze(true);
+  phase_players_iterate(pplayer)
+  {
+    if (is_ai(pplayer) && pplayer->ai->funcs.first_activities_plan) {
+      pool.start([pplayer] {
+        pplayer->ai->funcs.first_activities_plan(pplayer);
+      });
+    }
+  }
+  phase_players_iterate_end;
+  pool.waitForDone();
+  effect_cache_freeze(false);
+
+  timer_stop(plantimer);
+  qCDebug(timers_category, "AI planning in %.3f seconds.",
+          timer_read_seconds(plantimer));
+  timer_destroy(plantimer);
+}
+
 /**
    Called at the start of each (new) phase to do AI activities.
  */
 static void ai_start_phase()
 {
+  if (game.server.parallel_ai) {
+    ai_plan_phase();
+  }
+
   phase_players_iterate(pplayer)
   {
     if (is_ai(pplayer)) {
@@ -1107,8 +1178,9 @@ void begin_turn(bool is_new_turn)
   send_game_info(nullptr);
 
   if (is_new_turn) {
-    script_server_signal_emit("turn_begin", game.info.turn, game.info.year);
-    script_server_signal_emit("turn_started",
+    script_server_signal_emit(SSIG_TURN_BEGIN, game.info.turn,
+                              game.info.year);
+    script_server_signal_emit(SSIG_TURN_STARTED,
                               game.info.turn > 0 ? game.info.turn - 1
                                                  : game.info.turn,
                               game.info.year);
@@ -1221,6 +1293,7 @@ void begin_phase(bool is_new_phase)
   send_player_all_c(nullptr, nullptr);
 
   dlsend_packet_start_phase(game.est_connections, game.info.phase);
+  send_session_info(game.est_connections);
 
   if (!is_new_phase) {
     conn_list_iterate(game.est_connections, pconn)
@@ -1486,6 +1559,9 @@ void end_phase()
   }
   phase_players_iterate_end;
 
+  /* Cities touched by several players' updates are refreshed and sent
+   * only once, when all the updates are done. */
+  city_refresh_queue_freeze();
   alive_phase_players_iterate(pplayer)
   {
     do_tech_parasite_effect(pplayer);
@@ -1509,6 +1585,7 @@ void end_phase()
     flush_packets();
   }
   alive_phase_players_iterate_end;
+  city_refresh_queue_thaw();
 
   /* Some player/global effect may have changed cities' vision range */
   phase_players_iterate(pplayer) { refresh_player_cities_vision(pplayer); }
@@ -1637,7 +1714,7 @@ void end_turn()
 
       lsend_packet_achievement_info(first->connections, &pack);
 
-      script_server_signal_emit("achievement_gained", ach, first, true);
+      script_server_signal_emit(SSIG_ACHIEVEMENT_GAINED, ach, first, true);
     }
 
     pack.first = false;
@@ -1652,7 +1729,7 @@ void end_turn()
 
           lsend_packet_achievement_info(pplayer->connections, &pack);
 
-          script_server_signal_emit("achievement_gained", ach, pplayer,
+          script_server_signal_emit(SSIG_ACHIEVEMENT_GAINED, ach, pplayer,
                                     false);
         }
       }
@@ -1770,6 +1847,15 @@ void end_turn()
 
   log_debug("Sendyeartoclients");
   send_year_to_clients();
+
+  const struct effect_cache_stats *stats = effect_cache_stats_get();
+  log_time(QStringLiteral("Effect cache:%1 hits, %2 misses, "
+                          "%3 invalidations")
+               .arg(stats->hits)
+               .arg(stats->misses)
+               .arg(stats->invalidations));
+  effect_cache_stats_reset();
+
   log_time(QStringLiteral("End turn:%1 milliseconds").arg(timer.elapsed()));
 }
 
@@ -2035,6 +2121,13 @@ bool server_packet_input(server_connection *pconn, void *packet, int type)
         pconn, static_cast<struct packet_server_join_req *>(packet));
   }
 
+  // Comes before the join request.
+  if (type == PACKET_SESSION_RESUME_REQ) {
+    handle_session_resume_req(
+        pconn, static_cast<struct packet_session_resume_req *>(packet));
+    return true;
+  }
+
   // May be received on a non-established connection.
   if (type == PACKET_AUTHENTICATION_REPLY) {
     return auth_handle_reply(
@@ -2975,7 +3068,7 @@ void srv_ready()
     }
 
     if (wld.map.server.generator != MAPGEN_SCENARIO) {
-      script_server_signal_emit("map_generated");
+      script_server_signal_emit(SSIG_MAP_GENERATED);
     }
 
     game_map_init();
@@ -3003,6 +3096,8 @@ void srv_ready()
 
   // start the game
   set_server_state(S_S_RUNNING);
+  // The map and the players may have been set up directly.
+  effect_cache_invalidate();
   (void) send_server_info_to_metaserver(META_INFO);
 
   if (game.info.is_new_game) {
@@ -3165,6 +3260,8 @@ void server_game_free()
 {
   CALL_FUNC_EACH_AI(game_free);
 
+  session_free();
+
   // Free all the treaties that were left open when game finished.
   free_treaties();
 
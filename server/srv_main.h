@@ -118,6 +118,7 @@ const char *pick_random_player_name(const struct nation_type *pnation);
 void player_nation_defaults(struct player *pplayer,
                             struct nation_type *pnation, bool set_name);
 void send_all_info(struct conn_list *dest);
+void send_all_changed_info(server_connection *pconn, unsigned int since);
 
 void begin_turn(bool is_new_turn);
 void begin_phase(bool is_new_phase);
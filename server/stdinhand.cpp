@@ -32,6 +32,9 @@
 #include "unitlist.h"
 #include "version.h"
 
+/* common/scriptcore */
+#include "luascript_signal.h"
+
 // utility
 #include "astring.h"
 #include "bitvector.h"
@@ -4983,6 +4986,8 @@ static bool default_command(server_connection *caller, char *arg, bool check)
 #define SPECENUM_VALUE2NAME "unsafe-cmd"
 #define SPECENUM_VALUE3 LUA_UNSAFE_FILE
 #define SPECENUM_VALUE3NAME "unsafe-file"
+#define SPECENUM_VALUE4 LUA_SIGNALS
+#define SPECENUM_VALUE4NAME "signals"
 #include "specenum_gen.h"
 
 /**
@@ -4994,6 +4999,33 @@ static const char *lua_accessor(int i)
   return lua_args_name(static_cast<enum lua_args>(i));
 }
 
+/**
+   Show how often the server emitted each Lua signal and how much time the
+   callbacks connected to it took.
+ */
+static void lua_signals_report(server_connection *caller)
+{
+  cmd_reply(CMD_LUA, caller, C_COMMENT, horiz_line);
+  cmd_reply(CMD_LUA, caller, C_COMMENT, "%-30s %9s %10s %10s %9s",
+            _("Signal"), _("Callbacks"), _("Emitted"), _("Invoked"),
+            _("Time (ms)"));
+  cmd_reply(CMD_LUA, caller, C_COMMENT, horiz_line);
+  for (int sig = 0; sig < SSIG_COUNT; sig++) {
+    const struct signal *psignal =
+        script_server_signal_get(server_signal(sig));
+
+    if (psignal == nullptr) {
+      continue;
+    }
+
+    cmd_reply(CMD_LUA, caller, C_COMMENT, "%-30s %9d %10u %10u %9.1f",
+              server_signal_name(server_signal(sig)),
+              static_cast<int>(psignal->callbacks->size()),
+              psignal->emitted, psignal->invoked, psignal->nsecs / 1e6);
+  }
+  cmd_reply(CMD_LUA, caller, C_COMMENT, horiz_line);
+}
+
 /**
    Evaluate a line of lua script or a lua script file.
  */
@@ -5052,6 +5084,7 @@ static bool lua_command(server_connection *caller, char *arg, bool check,
 
   switch (ind) {
   case LUA_CMD:
+  case LUA_SIGNALS:
     // Nothing to check.
     break;
   case LUA_UNSAFE_CMD:
@@ -5119,6 +5152,10 @@ static bool lua_command(server_connection *caller, char *arg, bool check,
   case LUA_CMD:
     ret = script_server_do_string(caller, luaarg);
     break;
+  case LUA_SIGNALS:
+    lua_signals_report(caller);
+    ret = true;
+    break;
   case LUA_UNSAFE_CMD:
     ret = script_server_unsafe_do_string(caller, luaarg);
     break;
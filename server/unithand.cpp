@@ -27,6 +27,7 @@
 // common
 #include "actions.h"
 #include "ai.h"
+#include "borders.h"
 #include "city.h"
 #include "combat.h"
 #include "effects.h"
@@ -1833,89 +1834,32 @@ void handle_unit_get_actions(server_connection *pc, const int actor_unit_id,
 
   // Find out what can be done to the targets.
 
-  // Set the probability for the actions.
-  action_iterate(act)
-  {
-    if (action_id_get_actor_kind(act) != AAK_UNIT) {
-      // Not relevant.
-      continue;
-    }
+  /* Set the probability for the actions. Only a known city may be
+   * targeted. Don't bother with self targeted actions unless the actor is
+   * asking about what can be done to its own tile. */
+  action_probs_unit_vs_targets(
+      actor_unit, plrtile && plrtile->site ? target_city : nullptr,
+      target_unit, target_tile, target_extra, actor_target_distance == 0,
+      probabilities);
 
-    switch (action_id_get_target_kind(act)) {
-    case ATK_CITY:
-      if (plrtile && plrtile->site) {
-        // Only a known city may be targeted.
-        if (target_city) {
-          // Calculate the probabilities.
-          probabilities[act] =
-              action_prob_vs_city(actor_unit, act, target_city);
-        } else if (!tile_is_seen(target_tile, actor_player)
-                   && action_maybe_possible_actor_unit(act, actor_unit)
-                   && action_id_distance_accepted(act,
-                                                  actor_target_distance)) {
-          /* The target city is non existing. The player isn't aware of this
-           * fact because he can't see the tile it was located on. The
-           * actor unit it self doesn't contradict the requirements to
-           * perform the action. The (no longer existing) target city was
-           * known to be close enough. */
-          probabilities[act] = ACTPROB_NOT_KNOWN;
-        } else {
-          /* The actor unit is known to be unable to act or the target city
-           * is known to be too far away. */
-          probabilities[act] = ACTPROB_IMPOSSIBLE;
-        }
-      } else {
-        // No target to act against.
-        probabilities[act] = ACTPROB_IMPOSSIBLE;
-      }
-      break;
-    case ATK_UNIT:
-      if (target_unit) {
-        // Calculate the probabilities.
-        probabilities[act] =
-            action_prob_vs_unit(actor_unit, act, target_unit);
-      } else {
-        // No target to act against.
-        probabilities[act] = ACTPROB_IMPOSSIBLE;
-      }
-      break;
-    case ATK_UNITS:
-      if (target_tile) {
-        // Calculate the probabilities.
-        probabilities[act] =
-            action_prob_vs_units(actor_unit, act, target_tile);
-      } else {
-        // No target to act against.
-        probabilities[act] = ACTPROB_IMPOSSIBLE;
-      }
-      break;
-    case ATK_TILE:
-      if (target_tile) {
-        // Calculate the probabilities.
-        probabilities[act] =
-            action_prob_vs_tile(actor_unit, act, target_tile, target_extra);
-      } else {
-        // No target to act against.
-        probabilities[act] = ACTPROB_IMPOSSIBLE;
-      }
-      break;
-    case ATK_SELF:
-      if (actor_target_distance == 0) {
-        // Calculate the probabilities.
-        probabilities[act] = action_prob_self(actor_unit, act);
-      } else {
-        /* Don't bother with self targeted actions unless the actor is
-         * asking about what can be done to its own tile. */
-        probabilities[act] = ACTPROB_IMPOSSIBLE;
+  if (plrtile && plrtile->site && !target_city
+      && !tile_is_seen(target_tile, actor_player)) {
+    action_iterate(act)
+    {
+      if (action_id_get_actor_kind(act) == AAK_UNIT
+          && action_id_get_target_kind(act) == ATK_CITY
+          && action_maybe_possible_actor_unit(act, actor_unit)
+          && action_id_distance_accepted(act, actor_target_distance)) {
+        /* The target city is non existing. The player isn't aware of this
+         * fact because he can't see the tile it was located on. The actor
+         * unit it self doesn't contradict the requirements to perform the
+         * action. The (no longer existing) target city was known to be
+         * close enough. */
+        probabilities[act] = ACTPROB_NOT_KNOWN;
       }
-      break;
-    case ATK_COUNT:
-      fc_assert_action(action_id_get_target_kind(act) != ATK_COUNT,
-                       probabilities[act] = ACTPROB_IMPOSSIBLE);
-      break;
     }
+    action_iterate_end;
   }
-  action_iterate_end;
 
   /* Analyze the probabilities. Decide what targets to send and if an
    * explanation is needed. */
@@ -2809,7 +2753,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (pcity                                                                 \
       && is_action_enabled_unit_on_city(action_type, actor_unit, pcity)) {  \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_city",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_CITY,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2834,7 +2778,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (actor_unit                                                            \
       && is_action_enabled_unit_on_self(action_type, actor_unit)) {         \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_self",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_SELF,                \
                               action_by_number(action), actor);             \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2855,7 +2799,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (punit                                                                 \
       && is_action_enabled_unit_on_unit(action_type, actor_unit, punit)) {  \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_unit",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_UNIT,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2882,7 +2826,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
       && is_action_enabled_unit_on_units(action_type, actor_unit,           \
                                          target_tile)) {                    \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_units",                  \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_UNITS,               \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2903,7 +2847,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
       && is_action_enabled_unit_on_tile(action_type, actor_unit,            \
                                         target_tile, target_extra)) {       \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_tile",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_TILE,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -3385,6 +3329,7 @@ static bool city_add_unit(struct player *pplayer, struct unit *punit,
                           struct city *pcity, const struct action *paction)
 {
   int amount = unit_pop_value(punit);
+  int old_radius_sq;
 
   // Sanity check: The actor is still alive.
   fc_assert_ret_val(punit, false);
@@ -3394,7 +3339,12 @@ static bool city_add_unit(struct player *pplayer, struct unit *punit,
 
   fc_assert_ret_val(amount > 0, false);
 
+  old_radius_sq = tile_border_source_radius_sq(city_tile(pcity));
   city_size_add(pcity, amount);
+  // The border strength of the city changes with its size.
+  map_borders_dirty(city_tile(pcity),
+                    MAX(old_radius_sq,
+                        tile_border_source_radius_sq(city_tile(pcity))));
   // Make the new people something, otherwise city fails the checks
   pcity->specialists[DEFAULT_SPECIALIST] += amount;
   citizens_update(pcity, unit_nationality(punit));
@@ -3422,7 +3372,8 @@ static bool city_add_unit(struct player *pplayer, struct unit *punit,
 
   send_city_info(nullptr, pcity);
 
-  script_server_signal_emit("city_size_change", pcity, amount, "unit_added");
+  script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, amount,
+                            "unit_added");
 
   return true;
 }
@@ -4010,7 +3961,7 @@ static bool unit_do_destroy_city(struct player *act_player,
                              city_tile(tgt_city), city_link(tgt_city));
 
   // Run post city destruction Lua script.
-  script_server_signal_emit("city_destroyed", tgt_city, tgt_player,
+  script_server_signal_emit(SSIG_CITY_DESTROYED, tgt_city, tgt_player,
                             act_player);
 
   // Can't be sure of city existence after running script.
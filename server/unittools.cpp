@@ -65,6 +65,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sernet.h"
+#include "session.h"
 #include "srv_main.h"
 #include "techtools.h"
 #include "unithand.h"
@@ -1763,6 +1764,7 @@ void transform_unit(struct unit *punit, const struct unit_type *to_unit,
   }
 
   punit->utype = to_unit;
+  effect_cache_invalidate();
 
   /* New type may not have the same veteran system, and we may want to
    * knock some levels off. */
@@ -2071,6 +2073,7 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   }
 
   packet.unit_id = punit->id;
+  session_unit_removed(punit->id);
   // Send to onlookers.
   players_iterate(aplayer)
   {
@@ -2112,7 +2115,7 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
     player_status_add(unit_owner(punit), PSTATUS_DYING);
   }
 
-  script_server_signal_emit("unit_lost", punit, unit_owner(punit),
+  script_server_signal_emit(SSIG_UNIT_LOST, punit, unit_owner(punit),
                             unit_loss_reason_name(reason));
 
   script_server_remove_exported_object(punit);
@@ -2843,6 +2846,8 @@ void kill_unit(struct unit *pkiller, struct unit *punit, bool vet,
  */
 void package_unit(struct unit *punit, struct packet_unit_info *packet)
 {
+  session_unit_changed(punit);
+
   packet->id = punit->id;
   packet->owner = player_number(unit_owner(punit));
   packet->nationality = player_number(unit_nationality(punit));
@@ -2933,6 +2938,8 @@ void package_short_unit(struct unit *punit,
                         struct packet_unit_short_info *packet,
                         enum unit_info_use packet_use, int info_city_id)
 {
+  session_unit_changed(punit);
+
   packet->packet_use = packet_use;
   packet->info_city_id = info_city_id;
 
@@ -2976,6 +2983,7 @@ void package_short_unit(struct unit *punit,
  */
 void unit_goes_out_of_sight(struct player *pplayer, const unit *punit)
 {
+  session_unit_changed(punit);
   dlsend_packet_unit_remove(pplayer->connections, punit->id);
   if (punit->server.moving != nullptr) {
     // Update status of 'pplayer' vision for 'punit'.
@@ -2993,6 +3001,7 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   struct packet_unit_info info;
   struct packet_unit_short_info sinfo;
   struct unit_move_data *pdata;
+  const bv_player *seen_by;
 
   if (dest == nullptr) {
     dest = game.est_connections;
@@ -3004,6 +3013,9 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   package_unit(punit, &info);
   package_short_unit(punit, &sinfo, UNIT_INFO_IDENTITY, 0);
   pdata = punit->server.moving;
+  /* Nobody can see the unit without seeing its tile. Look up who does
+   * once instead of asking every connection's private map. */
+  seen_by = map_tile_seen_by(unit_tile(punit), V_MAIN);
 
   conn_list_iterate(dest, pconn)
   {
@@ -3024,7 +3036,9 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
       if (pdata != nullptr) {
         BV_SET(pdata->can_see_unit, player_index(pplayer));
       }
-    } else if (can_player_see_unit(pplayer, punit)) {
+    } else if ((seen_by == nullptr
+                || BV_ISSET(*seen_by, player_index(pplayer)))
+               && can_player_see_unit(pplayer, punit)) {
       send_packet_unit_short_info(pconn, &sinfo, false);
       if (pdata != nullptr) {
         BV_SET(pdata->can_see_unit, player_index(pplayer));
@@ -3186,7 +3200,7 @@ void do_nuclear_explosion(struct player *pplayer, struct tile *ptile)
   }
   square_iterate_end;
 
-  script_server_signal_emit("nuke_exploded", ptile, pplayer);
+  script_server_signal_emit(SSIG_NUKE_EXPLODED, ptile, pplayer);
   notify_conn(nullptr, ptile, E_NUKE, ftc_server,
               _("The %s detonated a nuke!"),
               nation_plural_for_player(pplayer));
@@ -3413,13 +3427,13 @@ static void unit_enter_hut(struct unit *punit)
       /* FIXME: enable different classes
        * to behave differently with different huts */
       if (behavior == HUT_FRIGHTEN) {
-        script_server_signal_emit("hut_frighten", punit,
+        script_server_signal_emit(SSIG_HUT_FRIGHTEN, punit,
                                   extra_rule_name(pextra));
       } else if (is_ai(pplayer) && has_handicap(pplayer, H_LIMITEDHUTS)) {
         // AI with H_LIMITEDHUTS only gets 25 gold (or barbs if unlucky)
         (void) hut_get_limited(punit);
       } else {
-        script_server_signal_emit("hut_enter", punit,
+        script_server_signal_emit(SSIG_HUT_ENTER, punit,
                                   extra_rule_name(pextra));
       }
 
@@ -4464,7 +4478,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
 
   if (unit_lives) {
     // Let the scripts run ...
-    script_server_signal_emit("unit_moved", punit, psrctile, pdesttile);
+    script_server_signal_emit(SSIG_UNIT_MOVED, punit, psrctile, pdesttile);
     unit_lives = unit_is_alive(saved_id);
   }
 
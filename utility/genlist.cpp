@@ -22,6 +22,13 @@
  * iterator is active, in particular removing the next element pointed
  * to by the iterator (see further comments below).
  *
+ * Lists that are modified and iterated very often, like the units on a
+ * tile, can be created with genlist_new_pooled(). Their links are then
+ * allocated in blocks, which keeps them close to each other in memory,
+ * and links of removed elements are kept for the next insertions instead
+ * of being freed. The pool thus keeps as many links as the list ever held
+ * at once; they are only released when the list is cleared or destroyed.
+ *
  * See also the speclist module.
  */
 
@@ -36,8 +43,22 @@
 #include <algorithm> // std::shuffle
 #include <cstddef>   // size_t
 #include <cstdlib>   // qsort
+#include <memory>    // std::unique_ptr
 #include <vector>    // std::vector
 
+// The first block of links of a pooled genlist has this many links.
+#define GENLIST_POOL_MIN_BLOCK 4
+// Blocks of links of pooled genlists have at most this many links.
+#define GENLIST_POOL_MAX_BLOCK 256
+
+/* Links of a pooled genlist. Unused links are chained through their next
+ * pointer. */
+struct genlist_pool {
+  struct genlist_link *free_links = nullptr;
+  int allocated = 0;
+  std::vector<std::unique_ptr<genlist_link[]>> blocks;
+};
+
 /**
    Create a new empty genlist.
  */
@@ -54,6 +75,21 @@ struct genlist *genlist_new_full(genlist_free_fn_t free_data_func)
   pgenlist->head_link = nullptr;
   pgenlist->tail_link = nullptr;
   pgenlist->free_data_func = free_data_func;
+  pgenlist->pool = nullptr;
+
+  return pgenlist;
+}
+
+/**
+   Create a new empty genlist that reuses the links of removed elements.
+   Meant for lists that change often. Copies of the list aren't pooled.
+   The links are only freed by genlist_clear() and genlist_destroy().
+ */
+struct genlist *genlist_new_pooled()
+{
+  genlist *pgenlist = genlist_new_full(nullptr);
+
+  pgenlist->pool = new genlist_pool;
 
   return pgenlist;
 }
@@ -68,9 +104,54 @@ void genlist_destroy(struct genlist *pgenlist)
   }
 
   genlist_clear(pgenlist);
+  delete pgenlist->pool;
   delete pgenlist;
 }
 
+/**
+   Returns an unused link of the pooled genlist, allocating a new block of
+   them if needed. The block size doubles with the number of links.
+ */
+static struct genlist_link *genlist_pool_take(struct genlist_pool *pool)
+{
+  struct genlist_link *plink;
+
+  if (nullptr == pool->free_links) {
+    const int size =
+        std::clamp(pool->allocated, GENLIST_POOL_MIN_BLOCK,
+                   GENLIST_POOL_MAX_BLOCK);
+    std::unique_ptr<genlist_link[]> block(new genlist_link[size]);
+
+    // Chain them in order so consecutive insertions are adjacent.
+    for (int i = 0; i < size - 1; i++) {
+      block[i].next = &block[i + 1];
+    }
+    block[size - 1].next = nullptr;
+    pool->free_links = &block[0];
+    pool->allocated += size;
+    pool->blocks.push_back(std::move(block));
+  }
+
+  plink = pool->free_links;
+  pool->free_links = plink->next;
+
+  return plink;
+}
+
+/**
+   Gives a link back to the pool of its genlist, or frees it.
+ */
+static void genlist_link_release(struct genlist *pgenlist,
+                                 struct genlist_link *plink)
+{
+  if (nullptr != pgenlist->pool) {
+    plink->next = pgenlist->pool->free_links;
+    pgenlist->pool->free_links = plink;
+  } else {
+    delete plink;
+  }
+}
+
 /**
    Create a new link.
  */
@@ -78,7 +159,9 @@ static void genlist_link_new(struct genlist *pgenlist, void *dataptr,
                              struct genlist_link *prev,
                              struct genlist_link *next)
 {
-  genlist_link *plink = new genlist_link;
+  genlist_link *plink = (nullptr != pgenlist->pool
+                             ? genlist_pool_take(pgenlist->pool)
+                             : new genlist_link);
 
   plink->dataptr = dataptr;
   plink->prev = prev;
@@ -121,7 +204,7 @@ static void genlist_link_destroy(struct genlist *pgenlist,
   if (nullptr != pgenlist->free_data_func) {
     pgenlist->free_data_func(plink->dataptr);
   }
-  delete plink;
+  genlist_link_release(pgenlist, plink);
 }
 
 /**
@@ -252,7 +335,8 @@ void *genlist_back(const struct genlist *pgenlist)
 /**
    Frees all the internal data used by the genlist (but doesn't touch
    the user-data).  At the end the state of the genlist will be the
-   same as when genlist_init() is called on a new genlist.
+   same as when genlist_init() is called on a new genlist. The links kept
+   by a pooled genlist are freed too.
  */
 void genlist_clear(struct genlist *pgenlist)
 {
@@ -271,15 +355,22 @@ void genlist_clear(struct genlist *pgenlist)
       do {
         plink2 = plink->next;
         free_data_func(plink->dataptr);
-        delete plink;
+        genlist_link_release(pgenlist, plink);
       } while (nullptr != (plink = plink2));
     } else {
       do {
         plink2 = plink->next;
-        delete plink;
+        genlist_link_release(pgenlist, plink);
       } while (nullptr != (plink = plink2));
     }
   }
+
+  if (nullptr != pgenlist->pool) {
+    // No link is in use any more.
+    pgenlist->pool->free_links = nullptr;
+    pgenlist->pool->allocated = 0;
+    pgenlist->pool->blocks.clear();
+  }
 }
 
 /**
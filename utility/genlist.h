@@ -12,6 +12,11 @@
 // A single element of a genlist, opaque type.
 struct genlist_link;
 
+/* Links kept for reuse by a pooled genlist, opaque type. The pool never
+ * shrinks when elements are removed: it holds as many links as the list
+ * ever had at once, until genlist_clear() or genlist_destroy(). */
+struct genlist_pool;
+
 // Function type definitions.
 typedef void (*genlist_free_fn_t)(void *);
 typedef void *(*genlist_copy_fn_t)(const void *);
@@ -20,18 +25,20 @@ typedef bool (*genlist_comp_fn_t)(const void *, const void *);
 
 /* A genlist, storing the number of elements (for quick retrieval and
  * testing for empty lists), and pointers to the first and last elements
- * of the list. */
+ * of the list. Pooled lists also keep their own links for reuse. */
 struct genlist {
   int nelements;
   QMutex mutex;
   struct genlist_link *head_link;
   struct genlist_link *tail_link;
   genlist_free_fn_t free_data_func;
+  struct genlist_pool *pool;
 };
 
 struct genlist *genlist_new() fc__warn_unused_result;
 struct genlist *
 genlist_new_full(genlist_free_fn_t free_data_func) fc__warn_unused_result;
+struct genlist *genlist_new_pooled() fc__warn_unused_result;
 void genlist_destroy(struct genlist *pgenlist);
 
 struct genlist *
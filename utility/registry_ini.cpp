@@ -157,7 +157,9 @@
 #include <KCompressionDevice>
 
 // Qt
+#include <QByteArray>
 #include <QByteArrayAlgorithms> // qstrlen, qstrdup
+#include <QHash>
 #include <QLoggingCategory>     // qCCritical. qCWarning
 #include <QString>
 #include <QStringLiteral>
@@ -220,6 +222,9 @@ struct entry {
 static struct entry *
 section_entry_filereference_new(struct section *psection, const char *name,
                                 const char *value);
+static struct section *
+secfile_section_by_utf8_name(const struct section_file *secfile,
+                             const char *name);
 
 /**
    Simplification of fileinfoname().
@@ -244,6 +249,16 @@ static bool is_secfile_entry_name_valid(const QString &name)
   return true;
 }
 
+/**
+   Returns a hash key referencing the given C string, without copying it.
+   The key must not outlive the string, so it is only suitable for
+   lookups.
+ */
+static inline QByteArray secfile_hash_key(const char *str)
+{
+  return QByteArray::fromRawData(str, qstrlen(str));
+}
+
 /**
    Insert an entry into the hash table.  Returns TRUE on success.
  */
@@ -261,7 +276,7 @@ static bool secfile_hash_insert(struct section_file *secfile,
 
   entry_path(pentry, buf, sizeof(buf));
 
-  hentry = secfile->hash.entries->value(buf, nullptr);
+  hentry = secfile->hash.entries->value(secfile_hash_key(buf), nullptr);
   if (hentry) {
     entry_use(hentry);
     if (!secfile->allow_duplicates) {
@@ -270,7 +285,7 @@ static bool secfile_hash_insert(struct section_file *secfile,
       return false;
     }
   }
-  secfile->hash.entries->insert(buf, pentry);
+  secfile->hash.entries->insert(QByteArray(buf), pentry);
   return true;
 }
 
@@ -289,7 +304,7 @@ static bool secfile_hash_delete(struct section_file *secfile,
   }
 
   entry_path(pentry, buf, sizeof(buf));
-  secfile->hash.entries->remove(buf);
+  secfile->hash.entries->remove(secfile_hash_key(buf));
   return true;
 }
 
@@ -542,7 +557,8 @@ static struct section_file *secfile_from_input_file(struct inputfile *inf,
   if (!error) {
     // Build the entry hash table.
     secfile->allow_duplicates = allow_duplicates;
-    secfile->hash.entries = new QMultiHash<QString, struct entry *>;
+    secfile->hash.entries = new QMultiHash<QByteArray, struct entry *>;
+    secfile->hash.entries->reserve(secfile->num_entries);
     section_list_iterate(secfile->sections, hashing_section)
     {
       entry_list_iterate(section_entries(hashing_section), pentry)
@@ -928,7 +944,7 @@ static struct section *secfile_insert_base(struct section_file *secfile,
   // Separates section and entry names.
   *ent_name = '\0';
   *pent_name = path + (ent_name - fullpath) + 1;
-  psection = secfile_section_by_name(secfile, fullpath);
+  psection = secfile_section_by_utf8_name(secfile, fullpath);
   if (psection) {
     return psection;
   } else {
@@ -1745,7 +1761,8 @@ struct entry *secfile_entry_by_path(const struct section_file *secfile,
   }
 
   if (nullptr != secfile->hash.entries) {
-    struct entry *pentry = secfile->hash.entries->value(fullpath, nullptr);
+    struct entry *pentry =
+        secfile->hash.entries->value(secfile_hash_key(fullpath), nullptr);
 
     if (pentry) {
       entry_use(pentry);
@@ -1762,7 +1779,7 @@ struct entry *secfile_entry_by_path(const struct section_file *secfile,
 
   // Separates section and entry names.
   *ent_name++ = '\0';
-  psection = secfile_section_by_name(secfile, fullpath);
+  psection = secfile_section_by_utf8_name(secfile, fullpath);
   if (psection) {
     return section_entry_by_name(psection, ent_name);
   } else {
@@ -2619,16 +2636,19 @@ int secfile_lookup_enum_default_data(const struct section_file *secfile,
 }
 
 /**
-   Returns the first section matching the name.
+   Returns the section matching the UTF-8 encoded name.
  */
-struct section *secfile_section_by_name(const struct section_file *secfile,
-                                        const QString &name)
+static struct section *
+secfile_section_by_utf8_name(const struct section_file *secfile,
+                             const char *name)
 {
-  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, nullptr != secfile, nullptr);
+  if (nullptr != secfile->hash.sections) {
+    return secfile->hash.sections->value(secfile_hash_key(name), nullptr);
+  }
 
   section_list_iterate(secfile->sections, psection)
   {
-    if (section_name(psection) == name) {
+    if (0 == qstrcmp(section_name(psection), name)) {
       return psection;
     }
   }
@@ -2637,6 +2657,17 @@ struct section *secfile_section_by_name(const struct section_file *secfile,
   return nullptr;
 }
 
+/**
+   Returns the first section matching the name.
+ */
+struct section *secfile_section_by_name(const struct section_file *secfile,
+                                        const QString &name)
+{
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, nullptr != secfile, nullptr);
+
+  return secfile_section_by_utf8_name(secfile, qUtf8Printable(name));
+}
+
 /**
    Find a section by path.
  */
@@ -2652,7 +2683,7 @@ struct section *secfile_section_lookup(const struct section_file *secfile,
   fc_vsnprintf(fullpath, sizeof(fullpath), path, args);
   va_end(args);
 
-  return secfile_section_by_name(secfile, fullpath);
+  return secfile_section_by_utf8_name(secfile, fullpath);
 }
 
 /**
@@ -2738,7 +2769,7 @@ struct section *secfile_section_new(struct section_file *secfile,
   section_list_append(secfile->sections, psection);
 
   if (nullptr != secfile->hash.sections) {
-    secfile->hash.sections->insert(psection->name, psection);
+    secfile->hash.sections->insert(QByteArray(psection->name), psection);
   }
 
   return psection;
@@ -2762,7 +2793,7 @@ void section_destroy(struct section *psection)
       return;
     }
     if (nullptr != secfile->hash.sections) {
-      secfile->hash.sections->remove(psection->name);
+      secfile->hash.sections->remove(secfile_hash_key(psection->name));
     }
   }
 
@@ -2806,9 +2837,10 @@ struct entry *section_entry_by_name(const struct section *psection,
   SECFILE_RETURN_VAL_IF_FAIL(nullptr, psection, nullptr != psection,
                              nullptr);
 
+  const QByteArray utf8 = name.toUtf8();
   entry_list_iterate(psection->entries, pentry)
   {
-    if (entry_name(pentry) == name) {
+    if (0 == qstrcmp(entry_name(pentry), utf8.constData())) {
       entry_use(pentry);
       return pentry;
     }
@@ -11,6 +11,8 @@
 #include "support.h"
 
 // Qt
+#include <QByteArray>
+#include <QHash>
 #include <QMultiHash>
 #include <QString>
 #include <QStringLiteral>
@@ -76,7 +78,7 @@ struct section_file *secfile_new(bool allow_duplicates)
   secfile->allow_duplicates = allow_duplicates;
   secfile->allow_digital_boolean = false; // Default
 
-  secfile->hash.sections = new QMultiHash<QString, struct section *>;
+  secfile->hash.sections = new QHash<QByteArray, struct section *>;
   // Maybe allocated later.
   secfile->hash.entries = nullptr;
 
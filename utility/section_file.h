@@ -8,11 +8,13 @@
 #include "support.h"
 
 // Qt
+class QByteArray;
 class QString;
 
 // std
 #include <cstddef> // size_t
 
+template <class Key, class T> class QHash;
 template <class Key, class T> class QMultiHash;
 
 // Section structure.
@@ -35,9 +37,11 @@ struct section_file {
   struct section_list *sections;
   bool allow_duplicates;
   bool allow_digital_boolean;
+  /* Lookup tables keyed by the UTF-8 names, so that lookups from C strings
+   * don't need any conversion or allocation. */
   struct {
-    QMultiHash<QString, struct section *> *sections;
-    QMultiHash<QString, struct entry *> *entries;
+    QHash<QByteArray, struct section *> *sections;
+    QMultiHash<QByteArray, struct entry *> *entries;
   } hash;
 };
 
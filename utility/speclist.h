@@ -34,6 +34,7 @@
  * and prototypes for the following functions:
  *    struct foo_list *foo_list_new(void);
  *    struct foo_list *foo_list_new_full(foo_list_free_fn_t free_data_func);
+ *    struct foo_list *foo_list_new_pooled(void);
  *    void foo_list_destroy(struct foo_list *plist);
  *    struct foo_list *foo_list_copy(const struct foolist *plist);
  *    struct foo_list *foo_list_copy_full(const struct foolist *plist,
@@ -178,6 +179,17 @@ SPECLIST_FOO(_list_new_full)(SPECLIST_FOO(_list_free_fn_t) free_data_func)
       reinterpret_cast<genlist_free_fn_t>(free_data_func))));
 }
 
+/****************************************************************************
+  Create a new speclist that reuses its links, see genlist_new_pooled().
+****************************************************************************/
+static inline SPECLIST_LIST *
+    SPECLIST_FOO(_list_new_pooled)() fc__warn_unused_result;
+
+static inline SPECLIST_LIST *SPECLIST_FOO(_list_new_pooled)()
+{
+  return reinterpret_cast<SPECLIST_LIST *>(genlist_new_pooled());
+}
+
 /****************************************************************************
   Free a speclist.
 ****************************************************************************/
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: Freeciv21 and Freeciv Contributors
+
+// utility
+#include "genlist.h"
+
+// Qt
+#include <QObject> // Q_OBJECT
+#include <QTest>
+#include <qtestcase.h>    // QCOMPARE, QVERIFY
+#include <qtmetamacros.h> // Q_OBJECT
+
+// Create a 'struct number_list' and related functions:
+#define SPECLIST_TAG number
+#define SPECLIST_TYPE int
+#include "speclist.h"
+#define number_list_iterate(numlist, pnum)                                  \
+  TYPED_LIST_ITERATE(int, numlist, pnum)
+#define number_list_iterate_end LIST_ITERATE_END
+#define number_list_link_iterate(numlist, plink)                            \
+  TYPED_LIST_LINK_ITERATE(struct number_list_link, numlist, plink)
+#define number_list_link_iterate_end LIST_LINK_ITERATE_END
+
+namespace {
+// Data stored in the lists.
+int numbers[100];
+
+/**
+ * Checks that the list holds exactly the numbers from first to last with
+ * the given step, in order.
+ */
+bool list_holds(const struct number_list *plist, int first, int last,
+                int step = 1)
+{
+  int expected = first;
+
+  if (number_list_size(plist) != (last - first) / step + 1) {
+    return false;
+  }
+  number_list_iterate(plist, pnum)
+  {
+    if (pnum != &numbers[expected]) {
+      return false;
+    }
+    expected += step;
+  }
+  number_list_iterate_end;
+
+  return true;
+}
+} // namespace
+
+/**
+ * Tests the pooled genlists, see \ref ::genlist_new_pooled
+ */
+class test_genlist : public QObject {
+  Q_OBJECT
+
+private slots:
+  void erase_while_iterating();
+  void clear_and_reuse();
+  void copy_is_not_pooled();
+  void destroy_after_reuse();
+};
+
+/**
+ * Removing elements within a link iteration must leave the next link valid,
+ * and the links of removed elements must be used again.
+ */
+void test_genlist::erase_while_iterating()
+{
+  struct number_list *plist = number_list_new_pooled();
+
+  for (int i = 0; i < 20; i++) {
+    number_list_append(plist, &numbers[i]);
+  }
+
+  // Drop the odd numbers.
+  number_list_link_iterate(plist, plink)
+  {
+    if ((number_list_link_data(plink) - numbers) % 2 == 1) {
+      number_list_erase(plist, plink);
+    }
+  }
+  number_list_link_iterate_end;
+  QVERIFY(list_holds(plist, 0, 18, 2));
+
+  // The last link given back is the first one taken.
+  struct number_list_link *plast = number_list_tail(plist);
+  number_list_erase(plist, plast);
+  number_list_append(plist, &numbers[50]);
+  QCOMPARE(number_list_tail(plist), plast);
+  QCOMPARE(number_list_back(plist), &numbers[50]);
+
+  number_list_destroy(plist);
+}
+
+/**
+ * A cleared pooled list must work like a new one.
+ */
+void test_genlist::clear_and_reuse()
+{
+  struct number_list *plist = number_list_new_pooled();
+
+  for (int i = 0; i < 50; i++) {
+    number_list_append(plist, &numbers[i]);
+  }
+  number_list_clear(plist);
+  QCOMPARE(number_list_size(plist), 0);
+  QVERIFY(nullptr == number_list_head(plist));
+  QVERIFY(nullptr == number_list_tail(plist));
+
+  for (int i = 0; i < 70; i++) {
+    number_list_append(plist, &numbers[i]);
+  }
+  QVERIFY(list_holds(plist, 0, 69));
+
+  // Clearing an empty list is fine too.
+  number_list_clear(plist);
+  number_list_clear(plist);
+  number_list_prepend(plist, &numbers[1]);
+  number_list_prepend(plist, &numbers[0]);
+  QVERIFY(list_holds(plist, 0, 1));
+
+  number_list_destroy(plist);
+}
+
+/**
+ * Copies of a pooled list own their links and outlive the original.
+ */
+void test_genlist::copy_is_not_pooled()
+{
+  struct number_list *plist = number_list_new_pooled();
+  struct number_list *pcopy;
+
+  for (int i = 0; i < 10; i++) {
+    number_list_append(plist, &numbers[i]);
+  }
+  pcopy = number_list_copy(plist);
+  QVERIFY(nullptr != reinterpret_cast<struct genlist *>(plist)->pool);
+  QVERIFY(nullptr == reinterpret_cast<struct genlist *>(pcopy)->pool);
+
+  number_list_clear(plist);
+  number_list_destroy(plist);
+  QVERIFY(list_holds(pcopy, 0, 9));
+
+  number_list_remove(pcopy, &numbers[9]);
+  number_list_append(pcopy, &numbers[10]);
+  number_list_destroy(pcopy);
+}
+
+/**
+ * Destroying a list must free the links in use and the spare ones alike.
+ */
+void test_genlist::destroy_after_reuse()
+{
+  struct number_list *plist = number_list_new_pooled();
+
+  // Grow over several blocks of links.
+  for (int i = 0; i < 100; i++) {
+    number_list_append(plist, &numbers[i]);
+  }
+  for (int i = 0; i < 60; i++) {
+    number_list_pop_front(plist);
+  }
+  for (int i = 0; i < 30; i++) {
+    number_list_insert(plist, &numbers[i], i);
+  }
+  QCOMPARE(number_list_size(plist), 70);
+  QCOMPARE(number_list_get(plist, 29), &numbers[29]);
+  QCOMPARE(number_list_get(plist, 30), &numbers[60]);
+
+  number_list_destroy(plist);
+}
+
+QTEST_MAIN(test_genlist)
+#include "test_genlist.moc"